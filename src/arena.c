@@ -0,0 +1,61 @@
+/** @file
+ * @brief Memory arena implementation
+ * @author 5cover, Matteo-K
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include "arena.h"
+#include "memdbg.h"
+
+tArena arena_create(void) {
+    return (tArena) {
+        ._allocation = NULL,
+        ._memory = NULL,
+        .capacity = 0,
+        ._used = 0,
+    };
+}
+
+void arena_reserve(tArena *arena, size_t capacity, char const *comment) {
+    (void)comment; // Unused when memory debugging is disabled
+
+    arena->_used = 0;
+
+    if (capacity <= arena->capacity) {
+        return;
+    }
+
+    arena_free(arena);
+
+    // Large arenas are aligned on huge pages so they can be backed by them.
+    size_t const alignment = capacity >= ARENA_HUGE_PAGE_SIZE ? ARENA_HUGE_PAGE_SIZE : ARENA_ALIGNMENT;
+
+    arena->_allocation = check_alloc(malloc(capacity + alignment - 1), "%s", comment);
+    arena->_memory = (unsigned char *)(((uintptr_t)arena->_allocation + alignment - 1) / alignment * alignment);
+    arena->capacity = capacity;
+
+#ifdef MADV_HUGEPAGE
+    if (alignment == ARENA_HUGE_PAGE_SIZE) {
+        // This is only advice, so failure is not an error.
+        madvise(arena->_memory, capacity / ARENA_HUGE_PAGE_SIZE * ARENA_HUGE_PAGE_SIZE, MADV_HUGEPAGE);
+    }
+#endif // MADV_HUGEPAGE
+}
+
+void *arena_alloc(tArena *arena, size_t size) {
+    assert(arena->_used + arena_size(size) <= arena->capacity);
+
+    void *array = arena->_memory + arena->_used;
+    arena->_used += arena_size(size);
+    return array;
+}
+
+void arena_free(tArena *arena) {
+    if (arena->_allocation != NULL) {
+        free(arena->_allocation);
+    }
+    *arena = arena_create();
+}
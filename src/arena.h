@@ -0,0 +1,84 @@
+/** @file
+ * @brief Memory arena header
+ * @author 5cover, Matteo-K
+ *
+ * An arena is a single contiguous block of memory from which many arrays are carved by bumping an offset.
+ * All the arrays of an arena are released at once by freeing or resetting the arena, so filling an arena costs O(1) allocator calls.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <assert.h>
+#include <stddef.h>
+
+/// @brief Integer: alignment of the arrays carved from an arena, in bytes. This is the size of a cache line.
+#define ARENA_ALIGNMENT 64
+
+/// @brief Integer: size of a huge page, in bytes.
+#define ARENA_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/// @brief Gets the number of bytes an array occupies in an arena.
+/// @param size in: the size of the array, in bytes
+/// @return @p size rounded up to @ref ARENA_ALIGNMENT.
+#define arena_size(size) (((size) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT)
+
+#define arena_array_size(name, length) arena_size(sizeof *(name) * (length))
+#define arena_array_alloc(arena, name, length) arena_alloc((arena), sizeof *(name) * (length))
+
+/// @brief A memory arena
+typedef struct {
+    /// @brief Pointer returned by the allocator.
+    /// @remark NULL when the arena holds no memory.
+    void *_allocation;
+
+    /// @brief Start of the usable memory, aligned on @ref ARENA_ALIGNMENT.
+    unsigned char *_memory;
+
+    /// @brief Size of the usable memory, in bytes.
+    size_t capacity;
+
+    /// @brief Number of bytes currently carved from the arena.
+    size_t _used;
+} tArena;
+
+/// @brief Creates an empty arena.
+/// @return An arena holding no memory.
+tArena arena_create(void);
+
+/// @brief Ensures an arena can hold a specific amount of memory and empties it.
+/// @param arena in/out: the arena
+/// @param capacity in: the number of bytes the arena must be able to hold
+/// @param comment in: comment of the allocation, for memory debugging
+/// @remark The memory of the arena is only reallocated if its current capacity is insufficient. Otherwise, it is reused.
+/// @remark Arenas of at least @ref ARENA_HUGE_PAGE_SIZE bytes are aligned on huge pages, and the system is advised to back them with huge pages when it supports it.
+void arena_reserve(tArena *arena, size_t capacity, char const *comment);
+
+/// @brief Carves an array from an arena.
+/// @param arena in/out: the arena
+/// @param size in: the size of the array, in bytes
+/// @return A pointer to the start of the array, aligned on @ref ARENA_ALIGNMENT. The memory is uninitialized.
+/// @remark The arena must have enough capacity left. Use @ref arena_size to compute the capacity to reserve.
+void *arena_alloc(tArena *arena, size_t size);
+
+/// @brief Gets the current position of an arena, to release all the arrays carved after it later.
+/// @param arena in: the arena
+/// @return A mark to pass to @ref arena_release.
+#define arena_mark(arena) ((arena)->_used)
+
+/// @brief Releases all the arrays carved from an arena since a mark was taken.
+/// @param arena in/out: the arena
+/// @param mark in: a mark returned by @ref arena_mark
+/// @remark Marks must be released in reverse order, like a stack.
+#define arena_release(arena, mark)          \
+    do {                                    \
+        assert((mark) <= (arena)->_used);   \
+        (arena)->_used = (mark);            \
+    } while (0)
+
+/// @brief Frees the memory of an arena.
+/// @param arena in/out: the arena. Is left empty.
+/// @remark It is safe to call this function on an empty arena.
+void arena_free(tArena *arena);
+
+#endif // ARENA_H
@@ -0,0 +1,156 @@
+/** @file
+ * @brief Bitset functions header
+ * @author 5cover, Matteo-K
+ *
+ * A bitset is an array of @ref tBitsetWord. Bit @c i is stored in word @c i/BITSET_WORD_BITS at position @c i%BITSET_WORD_BITS.
+ * Bitsets of up to @ref BITSET_WORD_BITS bits fit in a single word, so all operations reduce to one popcount or one ctz for grids up to N=8.
+ */
+
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <stddef.h>
+
+#include "types.h"
+
+// Using macros and inline functions to maximize the performance of these simple operations called very frequently in the program.
+
+/// @brief Integer: number of bits in a bitset word.
+#define BITSET_WORD_BITS 64
+
+/// @brief Gets the number of words needed to store a bitset.
+/// @param bitCount in: number of bits in the bitset
+/// @return The number of @ref tBitsetWord needed to store @p bitCount bits.
+#define bitset_wordCount(bitCount) (((bitCount) + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS)
+
+/// @brief Gets the mask of a bit in its word.
+#define bitset_bitMask(bit) ((tBitsetWord)1 << ((bit) % BITSET_WORD_BITS))
+
+/// @brief Gets the mask of the bits of a word that belong to a bitset.
+/// @param bitCount in: number of bits in the bitset
+/// @param word in: the index of the word
+/// @return A word with all the bits of word @p word that are in range [0 ; @p bitCount[ set.
+#define bitset_wordMask(bitCount, word)                                         \
+    ((size_t)((word) + 1) * BITSET_WORD_BITS <= (size_t)(bitCount)              \
+            ? ~(tBitsetWord)0                                                   \
+            : ((tBitsetWord)1 << ((bitCount) % BITSET_WORD_BITS)) - 1)
+
+/// @brief Determines whether a bit is set.
+/// @param set in: the bitset
+/// @param bit in: the zero-based index of the bit
+/// @return A boolean indicating whether @p bit is set in @p set.
+#define bitset_has(set, bit) (((set)[(bit) / BITSET_WORD_BITS] >> ((bit) % BITSET_WORD_BITS)) & 1)
+
+/// @brief Sets a bit.
+/// @param set in/out: the bitset
+/// @param bit in: the zero-based index of the bit
+#define bitset_add(set, bit) ((set)[(bit) / BITSET_WORD_BITS] |= bitset_bitMask(bit))
+
+/// @brief Clears a bit.
+/// @param set in/out: the bitset
+/// @param bit in: the zero-based index of the bit
+#define bitset_remove(set, bit) ((set)[(bit) / BITSET_WORD_BITS] &= ~bitset_bitMask(bit))
+
+#ifdef __GNUC__
+
+#define word_popcount(word) ((unsigned)__builtin_popcountll(word))
+#define word_ctz(word) ((unsigned)__builtin_ctzll(word))
+
+#else
+
+static inline unsigned word_popcount(tBitsetWord word) {
+    unsigned count = 0;
+    for (; word != 0; word &= word - 1) {
+        count++;
+    }
+    return count;
+}
+
+static inline unsigned word_ctz(tBitsetWord word) {
+    unsigned count = 0;
+    for (; (word & 1) == 0; word >>= 1) {
+        count++;
+    }
+    return count;
+}
+
+#endif // __GNUC__
+
+/// @brief Counts the set bits of a bitset.
+/// @param set in: the bitset
+/// @param wordCount in: the number of words of @p set
+/// @return The number of set bits in @p set.
+static inline unsigned bitset_count(tBitsetWord const *set, size_t wordCount) {
+    unsigned count = 0;
+    for (size_t w = 0; w < wordCount; w++) {
+        count += word_popcount(set[w]);
+    }
+    return count;
+}
+
+/// @brief Gets the first set bit of a non-empty bitset.
+/// @param set in: the bitset. Must have at least one bit set.
+/// @return The zero-based index of the lowest set bit of @p set.
+static inline int bitset_first(tBitsetWord const *set) {
+    size_t w = 0;
+    while (set[w] == 0) {
+        w++;
+    }
+    return w * BITSET_WORD_BITS + word_ctz(set[w]);
+}
+
+/// @brief Gets the nth set bit of a bitset.
+/// @param set in: the bitset
+/// @param n in: the one-based index of the set bit to get. Must not exceed the number of set bits in @p set.
+/// @return The zero-based index of the nth set bit of @p set.
+static inline int bitset_nth(tBitsetWord const *set, unsigned n) {
+    size_t w = 0;
+    unsigned count;
+    // Skip whole words
+    while ((count = word_popcount(set[w])) < n) {
+        n -= count;
+        w++;
+    }
+    // Clear the n-1 lowest set bits of the word
+    tBitsetWord word = set[w];
+    while (--n > 0) {
+        word &= word - 1;
+    }
+    return w * BITSET_WORD_BITS + word_ctz(word);
+}
+
+/// @brief Gets the next set bit of a bitset.
+/// @param set in: the bitset
+/// @param wordCount in: the number of words of @p set
+/// @param from in: the zero-based index of the bit to start searching from (included)
+/// @return The zero-based index of the lowest set bit of @p set that is greater than or equal to @p from, or -1 if there is none.
+static inline int bitset_next(tBitsetWord const *set, size_t wordCount, size_t from) {
+    size_t w = from / BITSET_WORD_BITS;
+    if (w >= wordCount) return -1;
+
+    tBitsetWord word = set[w] & (~(tBitsetWord)0 << (from % BITSET_WORD_BITS));
+    while (word == 0) {
+        if (++w == wordCount) return -1;
+        word = set[w];
+    }
+    return w * BITSET_WORD_BITS + word_ctz(word);
+}
+
+/// @brief Iterates over the set bits of a bitset in increasing order, starting from a specific bit.
+/// @param set in: the bitset
+/// @param wordCount in: the number of words of @p set
+/// @param from in: the zero-based index of the bit to start from (included)
+/// @param bitVarName Name of the loop variable to declare. It is assigned to the zero-based index of each set bit.
+/// @remark The bit being visited may be cleared in the loop body.
+#define bitset_forEachFrom(set, wordCount, from, bitVarName)                         \
+    for (int bitVarName = bitset_next((set), (wordCount), (from)); bitVarName != -1; \
+        bitVarName = bitset_next((set), (wordCount), bitVarName + 1))
+
+/// @brief Iterates over the set bits of a bitset in increasing order.
+/// @param set in: the bitset
+/// @param wordCount in: the number of words of @p set
+/// @param bitVarName Name of the loop variable to declare. It is assigned to the zero-based index of each set bit.
+/// @remark The bit being visited may be cleared in the loop body.
+#define bitset_forEach(set, wordCount, bitVarName) bitset_forEachFrom(set, wordCount, 0, bitVarName)
+
+#endif // BITSET_H
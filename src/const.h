@@ -15,9 +15,38 @@
 #define EXIT_INVALID_ARG 1
 /// @brief Integer: exit code for invalid data in a file
 #define EXIT_INVALID_DATA 2
+/// @brief Integer: exit code for a grid that has no solution
+#define EXIT_UNSOLVABLE 3
+/// @brief Integer: exit code for a search that gave up before finding a solution or proving there is none
+#define EXIT_GAVE_UP 4
 
-/// @brief Integer: size of a pair of candidates
-#define PAIR_SIZE 2
+/// @brief Integer: number of values read at once when loading a grid
+#define GRID_LOAD_CHUNK_LENGTH 1024
+
+/// @brief Integer: maximum number of decimal digits of a grid value
+#define GRID_VALUE_MAX_DIGITS 5
+
+/// @brief Integer: number of unit kinds (rows, columns and blocks)
+#define UNIT_KIND_COUNT 3
+
+/// @brief Integer: default maximum size of the naked and hidden subsets
+#define SUBSET_DEFAULT_MAX_SIZE 3
+
+/// @brief Integer: default maximum size of the fish (X-Wing, Swordfish, Jellyfish)
+#define FISH_DEFAULT_MAX_SIZE 4
+
+/// @brief Integer: number of techniques that can be scheduled (see @ref tTechnique)
+#define TECHNIQUE_COUNT 4
+
+/// @brief Integer: time, in nanoseconds, in which a technique that has not run yet is assumed to make one elimination.
+/// @remark This optimistic prior makes the scheduler try every technique of the plan before it trusts the measured yields.
+#define TECHNIQUE_YIELD_PRIOR_NS 1000
+
+/// @brief Integer: largest change of the cost of the local search by a swap: each of the two values leaves a row and a column and enters another.
+#define LOCAL_MAX_DELTA 8
+
+/// @brief Integer: default seed of the local search
+#define LOCAL_DEFAULT_SEED 1
 
 /// @brief Defines that the memory debugger should give verbose output.
 // #define MEMDBG_VERBOSE
@@ -0,0 +1,325 @@
+/** @file
+ * @brief Dancing Links engine implementation
+ * @author 5cover, Matteo-K
+ */
+
+#include <assert.h>
+
+#include "bitset.h"
+#include "dlx.h"
+#include "grid.h"
+#include "memdbg.h"
+#include "resolution.h"
+
+/// @brief Gets the size of the grids of a matrix.
+#define dlx_size(dlx) ((tIntSize2)(dlx).N * (dlx).N)
+
+/// @brief Gets the number of rows of a matrix: one per value of each cell.
+#define dlx_rowCount(dlx) (dlx_size(dlx) * dlx_size(dlx) * dlx_size(dlx))
+
+/// @brief Gets the number of columns of a matrix: one per cell, and one per value of each row, column and block.
+#define dlx_columnCount(dlx) (DLX_ROW_LENGTH * dlx_size(dlx) * dlx_size(dlx))
+
+/// @brief Gets the index of the header node of a column.
+#define dlx_header(dlx, column) (DLX_ROW_LENGTH * dlx_rowCount(dlx) + (column))
+
+/// @brief Gets the index of the root of the list of the uncovered columns.
+#define dlx_root(dlx) dlx_columnCount(dlx)
+
+/// @brief Gets the index of the first node of a row.
+#define dlx_rowStart(row) (DLX_ROW_LENGTH * (row))
+
+/// @brief Gets the index of the @p offset th node after a node, wrapping around its row.
+#define dlx_rowNode(node, offset) ((node) - (node) % DLX_ROW_LENGTH + ((node) + (offset)) % DLX_ROW_LENGTH)
+
+/// @brief Removes a node from its column.
+#define dlx_unlink(dlx, node)                                                       \
+    do {                                                                            \
+        tDlxNode const *_n = &(dlx)->_nodes[node];                                  \
+        (dlx)->_nodes[_n->down].up = _n->up;                                        \
+        (dlx)->_nodes[_n->up].down = _n->down;                                      \
+        (dlx)->_sizes[_n->column]--;                                                \
+    } while (0)
+
+/// @brief Puts a node removed with @ref dlx_unlink back in its column.
+/// @remark The nodes of a column must be put back in the reverse order they were removed.
+#define dlx_relink(dlx, node)                                                       \
+    do {                                                                            \
+        tDlxNode const *_n = &(dlx)->_nodes[node];                                  \
+        (dlx)->_nodes[_n->down].up = (node);                                        \
+        (dlx)->_nodes[_n->up].down = (node);                                        \
+        (dlx)->_sizes[_n->column]++;                                                \
+    } while (0)
+
+/// @brief Covers a column: removes it from the list of the uncovered columns, and removes the rows that have a node in it from the other columns.
+/// @param dlx in/out: the matrix
+/// @param column in: the column
+static inline void dlx_cover(tDlx *dlx, tIntSize2 column) {
+    dlx->_right[dlx->_left[column]] = dlx->_right[column];
+    dlx->_left[dlx->_right[column]] = dlx->_left[column];
+
+    tIntSize2 const header = dlx_header(*dlx, column);
+    for (tIntSize2 node = dlx->_nodes[header].down; node != header; node = dlx->_nodes[node].down) {
+        for (tIntSize2 offset = 1; offset < DLX_ROW_LENGTH; offset++) {
+            dlx_unlink(dlx, dlx_rowNode(node, offset));
+        }
+    }
+}
+
+/// @brief Uncovers a column covered with @ref dlx_cover.
+/// @param dlx in/out: the matrix
+/// @param column in: the column
+/// @remark The columns must be uncovered in the reverse order they were covered.
+static inline void dlx_uncover(tDlx *dlx, tIntSize2 column) {
+    tIntSize2 const header = dlx_header(*dlx, column);
+    for (tIntSize2 node = dlx->_nodes[header].up; node != header; node = dlx->_nodes[node].up) {
+        for (tIntSize2 offset = DLX_ROW_LENGTH - 1; offset > 0; offset--) {
+            dlx_relink(dlx, dlx_rowNode(node, offset));
+        }
+    }
+
+    dlx->_right[dlx->_left[column]] = column;
+    dlx->_left[dlx->_right[column]] = column;
+}
+
+/// @brief Covers the columns of the other nodes of the row of a node, once the row is chosen.
+/// @param dlx in/out: the matrix
+/// @param node in: the node, whose column is covered
+static inline void dlx_coverRow(tDlx *dlx, tIntSize2 node) {
+    for (tIntSize2 offset = 1; offset < DLX_ROW_LENGTH; offset++) {
+        dlx_cover(dlx, dlx->_nodes[dlx_rowNode(node, offset)].column);
+    }
+}
+
+/// @brief Uncovers the columns covered with @ref dlx_coverRow.
+/// @param dlx in/out: the matrix
+/// @param node in: the node
+static inline void dlx_uncoverRow(tDlx *dlx, tIntSize2 node) {
+    for (tIntSize2 offset = DLX_ROW_LENGTH - 1; offset > 0; offset--) {
+        dlx_uncover(dlx, dlx->_nodes[dlx_rowNode(node, offset)].column);
+    }
+}
+
+/// @brief Chooses the uncovered column that has the least rows.
+/// @param dlx in: the matrix. Must have an uncovered column.
+/// @return The chosen column.
+/// @remark A column with at most one row is forced, so it is chosen without looking at the columns after it.
+static inline tIntSize2 dlx_chooseColumn(tDlx const *dlx) {
+    tIntSize2 const root = dlx_root(*dlx);
+    tIntSize2 best = dlx->_right[root];
+    for (tIntSize2 column = dlx->_right[best]; column != root && dlx->_sizes[best] > 1; column = dlx->_right[column]) {
+        if (dlx->_sizes[column] < dlx->_sizes[best]) {
+            best = column;
+        }
+    }
+    return best;
+}
+
+tDlx dlx_create(tIntN N) {
+    assert(N <= DLX_MAX_N);
+
+    tDlx dlx = {
+        .N = N,
+        ._nodes = NULL,
+        ._sizes = NULL,
+        ._left = NULL,
+        ._right = NULL,
+        ._choices = NULL,
+        ._setupRows = NULL,
+        ._arena = arena_create(),
+    };
+
+    tIntSize2 const size = dlx_size(dlx);
+    tIntSize2 const nodeCount = DLX_ROW_LENGTH * dlx_rowCount(dlx) + dlx_columnCount(dlx);
+
+    arena_reserve(&dlx._arena,
+        arena_array_size(dlx._nodes, nodeCount)
+            + arena_array_size(dlx._sizes, dlx_columnCount(dlx))
+            + 2 * arena_array_size(dlx._left, dlx_columnCount(dlx) + 1),
+        "dancing links matrix");
+
+    dlx._nodes = arena_array_alloc(&dlx._arena, dlx._nodes, nodeCount);
+    dlx._sizes = arena_array_alloc(&dlx._arena, dlx._sizes, dlx_columnCount(dlx));
+    dlx._left = arena_array_alloc(&dlx._arena, dlx._left, dlx_columnCount(dlx) + 1);
+    dlx._right = arena_array_alloc(&dlx._arena, dlx._right, dlx_columnCount(dlx) + 1);
+
+    // Empty columns, all uncovered
+    for (tIntSize2 column = 0; column <= dlx_columnCount(dlx); column++) {
+        dlx._left[column] = column == 0 ? dlx_root(dlx) : column - 1;
+        dlx._right[column] = column == dlx_root(dlx) ? 0 : column + 1;
+    }
+    for (tIntSize2 column = 0; column < dlx_columnCount(dlx); column++) {
+        tIntSize2 const header = dlx_header(dlx, column);
+        dlx._nodes[header] = (tDlxNode) { .up = header, .down = header, .column = column };
+        dlx._sizes[column] = 0;
+    }
+
+    // Append the nodes of each row at the bottom of their columns, so that the rows of a column are in increasing order.
+    for (tIntSize2 iCell = 0; iCell < size * size; iCell++) {
+        tIntSize2 const row = iCell / size, col = iCell % size;
+        tIntSize2 const block = row / N * N + col / N;
+
+        for (tIntSize2 iValue = 0; iValue < size; iValue++) {
+            tIntSize2 const columns[DLX_ROW_LENGTH] = {
+                iCell,
+                size * size + row * size + iValue,
+                2 * size * size + col * size + iValue,
+                3 * size * size + block * size + iValue,
+            };
+            tIntSize2 const rowStart = dlx_rowStart(iCell * size + iValue);
+
+            for (tIntSize2 offset = 0; offset < DLX_ROW_LENGTH; offset++) {
+                tIntSize2 const node = rowStart + offset, header = dlx_header(dlx, columns[offset]);
+                dlx._nodes[node] = (tDlxNode) { .up = dlx._nodes[header].up, .down = header, .column = columns[offset] };
+                dlx._nodes[dlx._nodes[header].up].down = node;
+                dlx._nodes[header].up = node;
+                dlx._sizes[columns[offset]]++;
+            }
+        }
+    }
+
+    return dlx;
+}
+
+void dlx_free(tDlx *dlx) {
+    arena_free(&dlx->_arena);
+    *dlx = (tDlx) { .N = 0, ._arena = arena_create() };
+}
+
+size_t dlx_scratchSize(tGrid const *grid) {
+    // Choices + setup rows
+    return arena_size(sizeof(tIntSize2) * (grid_cellCount(*grid) + 1))
+         + arena_size(sizeof(tIntSize2) * (size_t)grid_cellCount(*grid) * grid_size(*grid));
+}
+
+void dlx_start(tDlx *dlx, tGrid *grid) {
+    assert(dlx->N == grid->N);
+
+    // Each cell receives at most one value, so there are at most as many choices as cells, plus the last depth.
+    dlx->_choices = arena_array_alloc(&grid->scratch, dlx->_choices, grid_cellCount(*grid) + 1);
+    // A row is either hidden or selected, at most once.
+    dlx->_setupRows = arena_array_alloc(&grid->scratch, dlx->_setupRows, (size_t)grid_cellCount(*grid) * grid_size(*grid));
+    dlx->_hiddenRowCount = 0;
+    dlx->_givenRowCount = 0;
+    dlx->_depth = 0;
+    dlx->_choices[0] = DLX_NO_NODE;
+    dlx->stats = (tSearchStats) { 0 };
+
+    // Hide the rows of the candidates eliminated from the empty cells, so that the search benefits from the techniques.
+    for (tIntSize2 iCell = 0; iCell < grid_cellCount(*grid); iCell++) {
+        if (grid_value(*grid, iCell) != 0) continue;
+        for (tIntSize iValue = 0; iValue < grid_size(*grid); iValue++) {
+            if (bitset_has(grid_candidates(*grid, iCell), iValue)) continue;
+
+            tIntSize2 const row = iCell * grid_size(*grid) + iValue;
+            for (tIntSize2 offset = 0; offset < DLX_ROW_LENGTH; offset++) {
+                dlx_unlink(dlx, dlx_rowStart(row) + offset);
+            }
+            dlx->_setupRows[dlx->_hiddenRowCount++] = row;
+        }
+    }
+
+    // Select the rows of the values of the grid. This removes the other rows of their cells and the rows they conflict with.
+    for (tIntSize2 iCell = 0; iCell < grid_cellCount(*grid); iCell++) {
+        if (grid_value(*grid, iCell) == 0) continue;
+
+        tIntSize2 const row = iCell * grid_size(*grid) + grid_value(*grid, iCell) - 1;
+        dlx_cover(dlx, dlx->_nodes[dlx_rowStart(row)].column);
+        dlx_coverRow(dlx, dlx_rowStart(row));
+        dlx->_setupRows[dlx->_hiddenRowCount + dlx->_givenRowCount++] = row;
+    }
+}
+
+tBacktrackingStatus dlx_run(tDlx *dlx, tGrid *grid, uint64_t nodeBudget) {
+    // The choices of the depths above the current one are the rows chosen so far. Their columns are covered.
+    // The choice of the current depth is the last row tried, or DLX_NO_NODE if its column is not chosen yet.
+    tIntSize2 depth = dlx->_depth;
+
+    for (;;) {
+        if (nodeBudget == 0) {
+            dlx->_depth = depth;
+            return BS_paused;
+        }
+
+        tIntSize2 node = dlx->_choices[depth];
+
+        if (node == DLX_NO_NODE) {
+            // All the columns are covered: the chosen rows are a solution.
+            if (dlx->_right[dlx_root(*dlx)] == dlx_root(*dlx)) {
+                for (tIntSize2 d = 0; d < depth; d++) {
+                    tIntSize2 const row = dlx->_choices[d] / DLX_ROW_LENGTH;
+                    grid_value(*grid, row / grid_size(*grid)) = row % grid_size(*grid) + 1;
+                }
+                dlx->_depth = depth;
+                return BS_solved;
+            }
+
+            // The rows of the chosen column are tried from its header.
+            tIntSize2 const column = dlx_chooseColumn(dlx);
+            dlx_cover(dlx, column);
+            node = dlx_header(*dlx, column);
+        } else {
+            // Choosing the last row has failed: give back the columns it covered.
+            dlx_uncoverRow(dlx, node);
+        }
+
+        node = dlx->_nodes[node].down;
+
+        if (node >= DLX_ROW_LENGTH * dlx_rowCount(*dlx)) {
+            // We failed for all the rows of the column: go back to the previous depth and try its next row.
+            dlx_uncover(dlx, dlx->_nodes[node].column);
+            dlx->_choices[depth] = DLX_NO_NODE;
+            dlx->stats.backtrackCount++;
+            if (depth == 0) {
+                dlx->_depth = 0;
+                return BS_exhausted;
+            }
+            depth--;
+            continue;
+        }
+
+        // assuming that this row is part of the solution,
+        dlx_coverRow(dlx, node);
+        dlx->_choices[depth] = node;
+        dlx->stats.nodeCount++;
+        nodeBudget -= nodeBudget != BACKTRACKING_NO_LIMIT;
+
+        // move on to the next column
+        dlx->_choices[++depth] = DLX_NO_NODE;
+    }
+}
+
+bool dlx_next(tDlx *dlx) {
+    assert(dlx->_choices[dlx->_depth] == DLX_NO_NODE);
+
+    // No row was chosen: the solution was forced.
+    if (dlx->_depth == 0) return false;
+
+    // Go back to the last chosen row: the next run gives back its columns and tries the next row.
+    dlx->_depth--;
+    return true;
+}
+
+void dlx_stop(tDlx *dlx) {
+    // Undo the choices of the search, deepest first.
+    for (tIntSize2 depth = dlx->_depth + 1; depth-- > 0;) {
+        tIntSize2 const node = dlx->_choices[depth];
+        if (node == DLX_NO_NODE) continue;
+        dlx_uncoverRow(dlx, node);
+        dlx_uncover(dlx, dlx->_nodes[node].column);
+    }
+
+    // Then the setup, in reverse order.
+    for (tIntSize2 i = dlx->_givenRowCount; i-- > 0;) {
+        tIntSize2 const rowStart = dlx_rowStart(dlx->_setupRows[dlx->_hiddenRowCount + i]);
+        dlx_uncoverRow(dlx, rowStart);
+        dlx_uncover(dlx, dlx->_nodes[rowStart].column);
+    }
+    for (size_t i = dlx->_hiddenRowCount; i-- > 0;) {
+        for (tIntSize2 offset = DLX_ROW_LENGTH; offset-- > 0;) {
+            dlx_relink(dlx, dlx_rowStart(dlx->_setupRows[i]) + offset);
+        }
+    }
+
+    dlx->_depth = 0;
+}
@@ -0,0 +1,69 @@
+/** @file
+ * @brief Dancing Links engine header
+ * @author 5cover, Matteo-K
+ *
+ * The grid is solved as an exact cover problem: choose one row of the matrix per column, such that no two chosen rows share a column.
+ * A row is a candidate of a cell, and a column is a constraint: cell, row-value, column-value or block-value. Each row has a 1 in exactly @ref DLX_ROW_LENGTH columns.
+ * Algorithm X covers the columns of each chosen row, removing from the matrix the rows that share them, and uncovers them in reverse order to backtrack. Dancing Links makes both operations O(1) per node by unlinking the nodes from their column lists and relinking them in place.
+ */
+
+#ifndef DLX_H
+#define DLX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "types.h"
+
+/// @brief Integer: number of nodes of a row of the matrix, one per constraint family.
+#define DLX_ROW_LENGTH 4
+
+/// @brief Integer: largest size factor whose matrix can be indexed by @ref tIntSize2.
+#define DLX_MAX_N 31
+
+/// @brief Integer: choice of a depth of the search at which no row is chosen yet.
+#define DLX_NO_NODE UINT_LEAST32_MAX
+
+/// @brief Builds the matrix of the grids of a size factor.
+/// @param N in: the size factor. Must not be greater than @ref DLX_MAX_N.
+/// @return The matrix, with all its rows and columns.
+/// @remark The matrix has SIZE³ rows, so it is only practical for small size factors.
+tDlx dlx_create(tIntN N);
+
+/// @brief Frees the memory of a matrix.
+/// @param dlx in/out: the matrix. Is left empty.
+/// @remark It is safe to call this function on an empty matrix.
+void dlx_free(tDlx *dlx);
+
+/// @brief Computes the size of the scratch arena needed by a search.
+/// @param grid in: the grid. Only its size factor is used.
+/// @return The number of bytes to reserve in the scratch arena of the grid.
+size_t dlx_scratchSize(tGrid const *grid);
+
+/// @brief Starts a search on the matrix.
+/// @param dlx in/out: the matrix, built for the size factor of @p grid, with all its rows and columns
+/// @param grid in/out: the grid. Its candidates must be consistent with its values. The stacks of the search are carved from its scratch arena.
+/// @remark The rows of the candidates the grid has eliminated are hidden, and the rows of the values of the grid are selected.
+void dlx_start(tDlx *dlx, tGrid *grid);
+
+/// @brief Runs a search until it ends or a number of nodes have been visited.
+/// @param dlx in/out: the matrix, on which a search was started with @ref dlx_start
+/// @param grid in/out: the grid
+/// @param nodeBudget in: the maximum number of rows to choose, or @ref BACKTRACKING_NO_LIMIT
+/// @return @ref BS_solved if a solution was found and written to the grid, @ref BS_exhausted if there is none, or @ref BS_paused if the budget ran out. A paused search is resumed by calling this function again.
+/// @remark The column with the least rows is covered first.
+/// @remark The candidates of the grid are not updated.
+tBacktrackingStatus dlx_run(tDlx *dlx, tGrid *grid, uint64_t nodeBudget);
+
+/// @brief Moves a search that found a solution on to the next one.
+/// @param dlx in/out: the matrix. Its last run must have returned @ref BS_solved.
+/// @return Whether other solutions may remain. If so, the next run searches for the next solution. Otherwise, the search is over.
+bool dlx_next(tDlx *dlx);
+
+/// @brief Stops a search, giving the matrix back all its rows and columns.
+/// @param dlx in/out: the matrix
+/// @remark The matrix can then be reused for another grid of its size factor.
+void dlx_stop(tDlx *dlx);
+
+#endif // DLX_H
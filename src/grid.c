@@ -10,173 +10,200 @@
 #include "const.h"
 #include "grid.h"
 #include "memdbg.h"
+#include "queue.h"
 #include "tCell.h"
 #include "utils.h"
 
 tGrid grid_create(tIntN const N) {
     return (tGrid) {
         .N = N,
-        .cells = NULL,
-        ._isBlockFree = NULL,
-        ._isColumnFree = NULL,
-        ._isRowFree = NULL,
+        ._values = NULL,
+        ._candidateCounts = NULL,
+        ._candidates = NULL,
+        ._unitValues = NULL,
+        ._unitPositions = NULL,
+        ._cellUnits = NULL,
+        ._cellPositions = NULL,
+        ._unitCells = NULL,
+        ._peers = NULL,
+        ._arena = arena_create(),
+        .scratch = arena_create(),
     };
 }
 
-int grid_load(FILE *inStream, tGrid *g) {
-#define fail_invalid_data()        \
-    do {                           \
-        free(gridValues);          \
-        return ERROR_INVALID_DATA; \
-    } while (0);
-
-    // As the .sud files only contain the grid values, we need a temporary integer grid to store them.
-    uint32_t *gridValues = check_alloc(array2d_malloc(gridValues, grid_size(*g), grid_size(*g)), "gridValues");
+/// @brief Computes the size of the arena holding all the arrays of a grid.
+/// @param grid in: the grid
+/// @return The number of bytes to reserve in the grid arena.
+static size_t grid_arenaSize(tGrid const *grid) {
+    return grid_stateSize(*grid)
+         + arena_array_size(grid->_cellUnits, (size_t)grid_cellCount(*grid) * UNIT_KIND_COUNT)
+         + arena_array_size(grid->_cellPositions, (size_t)grid_cellCount(*grid) * UNIT_KIND_COUNT)
+         + arena_array_size(grid->_unitCells, grid_unitCount(*grid) * grid_size(*grid))
+         + arena_array_size(grid->_peers, (size_t)grid_cellCount(*grid) * grid_peerCount(*grid))
+         + 2 * queue_arenaSize(grid_cellCount(*grid))
+         + queue_arenaSize(grid_unitCount(*grid));
+}
 
-    if (fread(gridValues, sizeof *gridValues, grid_size(*g) * grid_size(*g), inStream) != grid_size(*g) * grid_size(*g)) fail_invalid_data();
+/// @brief Builds the unit and peer index tables of a grid.
+/// @param grid in/out: the grid
+static void grid_buildTables(tGrid *grid) {
+    for (tIntSize r = 0; r < grid_size(*grid); r++) {
+        for (tIntSize c = 0; c < grid_size(*grid); c++) {
+            tIntSize2 const iCell = grid_cellIndex(*grid, r, c);
+            tIntSize const block = grid_blockAt(*grid, r, c);
+            tIntSize const blockPosition = r % grid->N * grid->N + c % grid->N;
+
+            grid_unitOf(*grid, iCell, UK_row) = grid_unit(*grid, UK_row, r);
+            grid_unitOf(*grid, iCell, UK_column) = grid_unit(*grid, UK_column, c);
+            grid_unitOf(*grid, iCell, UK_block) = grid_unit(*grid, UK_block, block);
+
+            grid_cellPosition(*grid, iCell, UK_row) = c;
+            grid_cellPosition(*grid, iCell, UK_column) = r;
+            grid_cellPosition(*grid, iCell, UK_block) = blockPosition;
+
+            grid_unitCellAt(*grid, grid_unit(*grid, UK_row, r), c) = iCell;
+            grid_unitCellAt(*grid, grid_unit(*grid, UK_column, c), r) = iCell;
+            grid_unitCellAt(*grid, grid_unit(*grid, UK_block, block), blockPosition) = iCell;
+
+            // Peers: the rest of the row, the rest of the column, then the cells of the block in neither.
+            tIntSize iPeer = 0;
+            for (tIntSize c2 = 0; c2 < grid_size(*grid); c2++) {
+                if (c2 != c) grid_peerAt(*grid, iCell, iPeer++) = grid_cellIndex(*grid, r, c2);
+            }
+            for (tIntSize r2 = 0; r2 < grid_size(*grid); r2++) {
+                if (r2 != r) grid_peerAt(*grid, iCell, iPeer++) = grid_cellIndex(*grid, r2, c);
+            }
+            tIntSize const blockRow = r - r % grid->N, blockCol = c - c % grid->N;
+            for (tIntSize r2 = blockRow; r2 < blockRow + grid->N; r2++) {
+                for (tIntSize c2 = blockCol; c2 < blockCol + grid->N; c2++) {
+                    if (r2 != r && c2 != c) grid_peerAt(*grid, iCell, iPeer++) = grid_cellIndex(*grid, r2, c2);
+                }
+            }
+            assert(iPeer == grid_peerCount(*grid));
+        }
+    }
+}
 
-    // Allocate and initialize all cells to 0 (candidates array is NULL, no value, 0 candidates)
-    g->cells = check_alloc(array2d_calloc(g->cells, grid_size(*g), grid_size(*g)), "grid cells array");
+int grid_load(FILE *inStream, tGrid *g) {
+    // Allocate all arrays at once. The arena of a previously loaded grid is reused if it is large enough.
+    arena_reserve(&g->_arena, grid_arenaSize(g), "grid arena");
+
+    // The state arrays come first, see grid_stateSize.
+    g->_values = arena_array_alloc(&g->_arena, g->_values, grid_cellCount(*g));
+    g->_candidateCounts = arena_array_alloc(&g->_arena, g->_candidateCounts, grid_cellCount(*g));
+    g->_candidates = arena_array_alloc(&g->_arena, g->_candidates, (size_t)grid_cellCount(*g) * grid_wordCount(*g));
+    g->_unitValues = arena_array_alloc(&g->_arena, g->_unitValues, grid_unitCount(*g) * grid_wordCount(*g));
+    g->_unitPositions = arena_array_alloc(&g->_arena, g->_unitPositions, (size_t)grid_unitCount(*g) * grid_size(*g) * grid_wordCount(*g));
+    g->_cellUnits = arena_array_alloc(&g->_arena, g->_cellUnits, (size_t)grid_cellCount(*g) * UNIT_KIND_COUNT);
+    g->_cellPositions = arena_array_alloc(&g->_arena, g->_cellPositions, (size_t)grid_cellCount(*g) * UNIT_KIND_COUNT);
+    g->_unitCells = arena_array_alloc(&g->_arena, g->_unitCells, grid_unitCount(*g) * grid_size(*g));
+    g->_peers = arena_array_alloc(&g->_arena, g->_peers, (size_t)grid_cellCount(*g) * grid_peerCount(*g));
+
+    // Initialize everything to 0 (no value, no candidates, all values free)
+    memset(g->_arena._memory, 0, g->_arena._used);
+
+    grid_buildTables(g);
+
+    g->_placedCells = queue_create(&g->_arena, grid_cellCount(*g));
+    g->_dirtyCells = queue_create(&g->_arena, grid_cellCount(*g));
+    g->_dirtyUnits = queue_create(&g->_arena, grid_unitCount(*g));
+    g->eliminationCount = 0;
+    g->hasContradiction = false;
+
+    // As the .sud files only contain the grid values, we read them by chunks in a temporary buffer.
+    uint32_t gridValues[GRID_LOAD_CHUNK_LENGTH];
+    size_t iGridValue = GRID_LOAD_CHUNK_LENGTH;
 
-    // Allocate row, column and block arrays
-    g->_isColumnFree = check_alloc(array2d_malloc(g->_isColumnFree, grid_size(*g), grid_size(*g) + 1), "grid _isColumnFree array");
-    g->_isRowFree = check_alloc(array2d_malloc(g->_isRowFree, grid_size(*g), grid_size(*g) + 1), "grid _isRowFree array");
-    g->_isBlockFree = check_alloc(array3d_malloc(g->_isBlockFree, g->N, g->N, grid_size(*g) + 1), "grid _isBlockFree array");
+    // Initialize cells and mark them as not free
+    for (tIntSize2 iCell = 0; iCell < grid_cellCount(*g); iCell++) {
+        if (iGridValue == GRID_LOAD_CHUNK_LENGTH) {
+            size_t const chunkLength = min((size_t)(grid_cellCount(*g) - iCell), (size_t)GRID_LOAD_CHUNK_LENGTH);
+            if (fread(gridValues, sizeof *gridValues, chunkLength, inStream) != chunkLength) return ERROR_INVALID_DATA;
+            iGridValue = 0;
+        }
 
-    // Initialize all rows, columns and blocks to free
-    memset(g->_isRowFree, true, sizeof(bool) * grid_size(*g) * (grid_size(*g) + 1));
-    memset(g->_isColumnFree, true, sizeof(bool) * grid_size(*g) * (grid_size(*g) + 1));
-    memset(g->_isBlockFree, true, sizeof(bool) * g->N * g->N * (grid_size(*g) + 1));
+        uint32_t value = gridValues[iGridValue++];
 
-    // Initialize cells and mark them as not free
-    for (tIntSize r = 0; r < grid_size(*g); r++) {
-        for (tIntSize c = 0; c < grid_size(*g); c++) {
-            tIntSize value = gridValues[at2d(grid_size(*g), r, c)];
-            tCell *cell = &grid_cellAt(*g, r, c);
-
-            cell->hasCandidate = check_alloc(array_calloc(cell->hasCandidate, grid_size(*g) + 1),
-                "grid cell %d,%d hasCandidate array", r, c);
-
-            if (value != 0) {
-                if (value > grid_size(*g)) fail_invalid_data();
-                cell->_value = value;
-                grid_markValueFree(false, *g, r, c, value);
-            }
+        if (value != 0) {
+            if (value > (uint32_t)grid_size(*g)) return ERROR_INVALID_DATA;
+            // The value is already given in a unit of the cell.
+            g->hasContradiction |= !grid_possible(*g, iCell, value);
+            grid_value(*g, iCell) = value;
+            grid_markValueFree(false, *g, iCell, value);
         }
     }
 
     // Add candidates
-    for (tIntSize r = 0; r < grid_size(*g); r++) {
-        for (tIntSize c = 0; c < grid_size(*g); c++) {
-            tCell *cell = &grid_cellAt(*g, r, c);
-            // No need to compute the candidates of a cell that already has a value.
-            if (!cell_hasValue(*cell)) {
-                // compute the cell's candidates
-                for (tIntSize candidate = 1; candidate <= grid_size(*g); candidate++) {
-                    bool possible = grid_possible(*g, r, c, candidate);
-                    // add the candidate
-                    cell->hasCandidate[candidate] = possible;
-                    cell->_candidateCount += possible;
+    for (tIntSize2 iCell = 0; iCell < grid_cellCount(*g); iCell++) {
+        // No need to compute the candidates of a cell that already has a value.
+        if (grid_value(*g, iCell) == 0) {
+            tBitsetWord *candidates = grid_candidates(*g, iCell);
+            // compute the cell's candidates: all the values that are possible
+            for (tIntSize w = 0; w < grid_wordCount(*g); w++) {
+                candidates[w] = grid_cellPossibleValues(*g, iCell, w);
+                grid_candidateCount(*g, iCell) += word_popcount(candidates[w]);
+            }
+            // The values of the peers of the cell leave it no candidates.
+            g->hasContradiction |= grid_candidateCount(*g, iCell) == 0;
+            // register the cell's position in its units for each of its candidates
+            bitset_forEach(candidates, grid_wordCount(*g), bit) {
+                for (tIntSize kind = 0; kind < UNIT_KIND_COUNT; kind++) {
+                    bitset_add(grid_unitPositions(*g, grid_unitOf(*g, iCell, kind), bit + 1), grid_cellPosition(*g, iCell, kind));
                 }
             }
         }
     }
 
-    free(gridValues);
     return 0;
 }
 
 void grid_free(tGrid *grid) {
-    for (tIntSize r = 0; r < grid_size(*grid); r++) {
-        for (tIntSize c = 0; c < grid_size(*grid); c++) {
-            free(grid_cellAt(*grid, r, c).hasCandidate);
-        }
-    }
-    free(grid->cells);
-    free(grid->_isBlockFree);
-    free(grid->_isColumnFree);
-    free(grid->_isRowFree);
+    arena_free(&grid->_arena);
+    arena_free(&grid->scratch);
+    grid->_values = NULL;
+    grid->_candidateCounts = NULL;
+    grid->_candidates = NULL;
+    grid->_unitValues = NULL;
+    grid->_unitPositions = NULL;
+    grid->_cellUnits = NULL;
+    grid->_cellPositions = NULL;
+    grid->_unitCells = NULL;
+    grid->_peers = NULL;
+    grid->_placedCells = grid->_dirtyCells = grid->_dirtyUnits = (tQueue) { 0 };
 }
 
-bool grid_cell_removeCandidate(tGrid *grid, tIntSize row, tIntSize column, tIntSize candidate) {
-    tCell *cell = &grid_cellAt(*grid, row, column);
-
-    assert(1 <= candidate && candidate <= grid_size(*grid));
-
-    // If the cell has only one candidate remaining and it's the one we want to remove, set it as the cell's value and remove it.
-    if (cell_candidate_count(*cell) == 1) {
-        cell_get_first_candidate(*cell, onlyCandidate);
-        if (onlyCandidate == candidate) {
-            cell->_value = onlyCandidate;
-            cell->hasCandidate[candidate] = false;
-            cell->_candidateCount = 0;
-            grid_markValueFree(false, *grid, row, column, candidate);
-            return true;
+void grid_write(tGrid const *grid, FILE *outStream) {
+    // The value plane is written by chunks, in the same order as it is stored.
+    uint32_t gridValues[GRID_LOAD_CHUNK_LENGTH];
+    for (tIntSize2 iChunk = 0; iChunk < grid_cellCount(*grid); iChunk += GRID_LOAD_CHUNK_LENGTH) {
+        size_t const chunkLength = min((size_t)(grid_cellCount(*grid) - iChunk), (size_t)GRID_LOAD_CHUNK_LENGTH);
+        for (size_t i = 0; i < chunkLength; i++) {
+            gridValues[i] = grid_value(*grid, iChunk + i);
         }
+        fwrite(gridValues, sizeof *gridValues, chunkLength, outStream);
     }
-
-    // Otherwise proceed as usual
-    bool possible = cell_hasCandidate(*cell, candidate);
-    if (possible) {
-        cell->hasCandidate[candidate] = false;
-        cell->_candidateCount--;
-    }
-
-    return possible;
-}
-
-void grid_cell_provideValue(tGrid *grid, tIntSize row, tIntSize column, tIntSize value) {
-    assert(grid_possible(*grid, row, column, value));
-
-    tCell *cell = &grid_cellAt(*grid, row, column);
-
-    assert(1 <= value && value <= grid_size(*grid));
-    assert(!cell_hasValue(*cell));
-
-    cell->_value = value;
-    cell->_candidateCount = 0;
-    memset(cell->hasCandidate, false, sizeof(bool) * grid_size(*grid) + 1);
-    grid_markValueFree(false, *grid, row, column, value);
 }
 
-bool grid_removeCandidateFromRow(tGrid *grid, tIntSize row, tIntSize candidate) {
-    bool progress = false;
-    for (tIntSize c = 0; c < grid_size(*grid); c++) {
-        progress |= grid_cell_removeCandidate(grid, row, c, candidate);
-    }
-    return progress;
-}
-
-bool grid_removeCandidateFromColumn(tGrid *grid, tIntSize column, tIntSize candidate) {
-    bool progress = false;
-    for (tIntSize r = 0; r < grid_size(*grid); r++) {
-        progress |= grid_cell_removeCandidate(grid, r, column, candidate);
-    }
-    return progress;
-}
-
-bool grid_removeCandidateFromBlock(tGrid *grid, tIntSize row, tIntSize column, tIntSize candidate) {
-    bool progress = false;
-
-    tIntSize const blockRow = grid_blockIndex(*grid, row);
-    tIntSize const blockCol = grid_blockIndex(*grid, column);
-
-    for (tIntSize r = blockRow; r < blockRow + grid->N; r++) {
-        for (tIntSize c = blockCol; c < blockCol + grid->N; c++) {
-            progress |= grid_cell_removeCandidate(grid, r, c, candidate);
+void grid_writeLine(tGrid const *grid, FILE *outStream) {
+    int const padding = digitCount(grid_size(*grid), 10);
+
+    // The line is formatted by chunks, without printf, so that writing many solutions stays cheap.
+    char line[GRID_LOAD_CHUNK_LENGTH * GRID_VALUE_MAX_DIGITS];
+    for (tIntSize2 iChunk = 0; iChunk < grid_cellCount(*grid); iChunk += GRID_LOAD_CHUNK_LENGTH) {
+        size_t const chunkLength = min((size_t)(grid_cellCount(*grid) - iChunk), (size_t)GRID_LOAD_CHUNK_LENGTH);
+        char *end = line;
+        for (size_t i = 0; i < chunkLength; i++) {
+            tIntSize value = grid_value(*grid, iChunk + i);
+            end += padding;
+            for (char *digit = end - 1; digit >= end - padding; digit--) {
+                *digit = '0' + value % 10;
+                value /= 10;
+            }
         }
+        fwrite(line, 1, end - line, outStream);
     }
 
-    return progress;
-}
-
-void grid_write(tGrid const *grid, FILE *outStream) {
-    for (tIntSize r = 0; r < grid_size(*grid); r++) {
-        for (tIntSize c = 0; c < grid_size(*grid); c++) {
-            uint32_t value32 = grid_cellAt(*grid, r, c)._value;
-            fwrite(&value32, sizeof(uint32_t), 1, outStream);
-        }
-    }
+    putc('\n', outStream);
 }
 
 void grid_print(tGrid const *grid, FILE *outStream) {
@@ -215,7 +242,7 @@ void grid_printRow(tGrid const *grid, tIntSize row, int padding, FILE *outStream
     // Print line content
     for (tIntSize block = 0; block < grid->N; block++) {
         for (tIntSize blockCol = 0; blockCol < grid->N; blockCol++) {
-            printValue(grid_cellAt(*grid, row, block * grid->N + blockCol)._value, padding, outStream);
+            printValue(grid_value(*grid, grid_cellIndex(*grid, row, block * grid->N + blockCol)), padding, outStream);
         }
         putc(DISPLAY_VERTICAL_LINE, outStream);
     }
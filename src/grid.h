@@ -6,58 +6,223 @@
 #ifndef SUDOKU_H
 #define SUDOKU_H
 
+#include <assert.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
+#include "bitset.h"
+#include "queue.h"
+#include "tCell.h"
 #include "types.h"
 
 // Using macros to maximize the performance of these simple functions called very frequently in the program.
 
-#define grid_size(grid) ((grid).N * (grid).N)
+/// @brief Gets the size factor of a grid.
+/// @remark In a solver kernel, this is the compile-time constant @ref KERNEL_N. This allows the compiler to unroll and vectorize the loops over the grid.
+#ifdef KERNEL_N
+#define grid_N(grid) KERNEL_N
+#else
+#define grid_N(grid) ((grid).N)
+#endif
 
-#define grid_cellAt(grid, row, column) (grid).cells[at2d(grid_size(grid), (row), (column))]
-#define grid_cellAtPos(grid, pos) grid_cellAt(grid, pos.row, pos.column)
-/// @brief Defines whether a value is free or not at a position on the grid.
-#define grid_markValueFree(isFree, grid, row, column, value)                                                             \
-    do {                                                                                                                 \
-        assert((row) < grid_size(grid));                                                                                     \
-        assert((column) < grid_size(grid));                                                                                  \
-        assert((value) <= grid_size(grid));                                                                                  \
-        (grid)._isColumnFree[at2d(grid_size(grid) + 1, (column), (value))] = (isFree);                                       \
-        (grid)._isRowFree[at2d(grid_size(grid) + 1, (row), (value))] = (isFree);                                             \
-        (grid)._isBlockFree[at3d((grid).N, grid_size(grid) + 1, (row) / (grid).N, (column) / (grid).N, (value))] = (isFree); \
+/// @brief Gets the size of a grid (the number of rows, columns, blocks and values).
+#define grid_size(grid) (grid_N(grid) * grid_N(grid))
+
+/// @brief Gets the number of bitset words needed to store the candidates of a cell.
+#define grid_wordCount(grid) bitset_wordCount(grid_size(grid))
+
+/// @brief Gets the number of cells of a grid.
+#define grid_cellCount(grid) ((tIntSize2)grid_size(grid) * grid_size(grid))
+
+/// @brief Gets the number of units (rows, columns and blocks) of a grid.
+#define grid_unitCount(grid) (UNIT_KIND_COUNT * grid_size(grid))
+
+/// @brief Gets the number of peers of a cell (the cells that share a unit with it, excluding itself).
+// SIZE - 1 cells in the row, SIZE - 1 in the column, and the (N - 1)² cells of the block that are in neither.
+#define grid_peerCount(grid) (UNIT_KIND_COUNT * grid_size(grid) - 2 * grid_N(grid) - 1)
+
+/// @brief Gets the number of bytes of the state of a grid: the arrays that change while it is solved.
+/// @return The size of the value, candidate count and candidate planes and of the value and position bitsets of the units, in the grid arena.
+/// @remark These arrays are carved first and contiguously from the grid arena, so the state of a grid is the @ref grid_stateSize bytes starting at @ref tGrid._values.
+#define grid_stateSize(grid)                                                                                                  \
+    (arena_array_size((grid)._values, grid_cellCount(grid))                                                                   \
+        + arena_array_size((grid)._candidateCounts, grid_cellCount(grid))                                                     \
+        + arena_array_size((grid)._candidates, (size_t)grid_cellCount(grid) * grid_wordCount(grid))                           \
+        + arena_array_size((grid)._unitValues, grid_unitCount(grid) * grid_wordCount(grid))                                   \
+        + arena_array_size((grid)._unitPositions, (size_t)grid_unitCount(grid) * grid_size(grid) * grid_wordCount(grid)))
+
+/// @brief Gets the index of a cell from its position.
+/// @param grid in: the grid
+/// @param row in: the cell's row
+/// @param column in: the cell's column
+/// @return The index of the cell in range [0 ; SIZE²[, cells being numbered from left to right then top to bottom.
+#define grid_cellIndex(grid, row, column) at2d(grid_size(grid), (row), (column))
+
+/// @brief Gets the value of a cell, 0 if it is empty.
+/// @param grid in: the grid
+/// @param iCell in: the index of the cell
+/// @return An lvalue: the element of the value plane of the grid for the cell.
+#define grid_value(grid, iCell) (grid)._values[iCell]
+
+/// @brief Gets the number of candidates of a cell.
+/// @param grid in: the grid
+/// @param iCell in: the index of the cell
+/// @return An lvalue: the element of the candidate count plane of the grid for the cell.
+#define grid_candidateCount(grid, iCell) (grid)._candidateCounts[iCell]
+
+/// @brief Gets the candidates of a cell.
+/// @param grid in: the grid
+/// @param iCell in: the index of the cell
+/// @return A pointer to the bitset of the candidates of the cell, in the candidate plane of the grid.
+#define grid_candidates(grid, iCell) (&(grid)._candidates[at2d(grid_wordCount(grid), (iCell), 0)])
+
+/// @brief Gets a view of a cell.
+/// @param grid in: the grid
+/// @param iCell in: the index of the cell
+/// @return A @ref tCell pointing to the elements of the cell in the planes of the grid.
+#define grid_cellAtIndex(grid, iCell)           \
+    ((tCell) {                                  \
+        &grid_value(grid, iCell),               \
+        &grid_candidateCount(grid, iCell),      \
+        grid_candidates(grid, iCell),           \
+    })
+#define grid_cellAt(grid, row, column) grid_cellAtIndex(grid, grid_cellIndex(grid, (row), (column)))
+
+/// @brief Gets the index of a unit.
+/// @param grid in: the grid
+/// @param kind in: the kind of the unit (@ref tUnitKind)
+/// @param index in: the index of the unit among the units of its kind (row, column or block number)
+/// @return The index of the unit in range [0 ; 3 * SIZE[.
+#define grid_unit(grid, kind, index) ((kind) * grid_size(grid) + (index))
+
+/// @brief Gets the kind of a unit.
+/// @param grid in: the grid
+/// @param unit in: the index of the unit
+/// @return The kind of the unit (@ref tUnitKind).
+#define grid_unitKind(grid, unit) ((tUnitKind)((unit) / grid_size(grid)))
+
+/// @brief Gets the index of the unit of a specific kind containing a cell.
+/// @param grid in: the grid
+/// @param iCell in: the index of the cell
+/// @param kind in: the kind of the unit (@ref tUnitKind)
+/// @return The index of the unit of kind @p kind containing the cell.
+#define grid_unitOf(grid, iCell, kind) (grid)._cellUnits[at2d(UNIT_KIND_COUNT, (iCell), (kind))]
+
+/// @brief Gets the position of a cell in the unit of a specific kind containing it.
+/// @param grid in: the grid
+/// @param iCell in: the index of the cell
+/// @param kind in: the kind of the unit (@ref tUnitKind)
+/// @return The position of the cell in the unit, in range [0 ; SIZE[. See @ref grid_unitCellAt.
+#define grid_cellPosition(grid, iCell, kind) (grid)._cellPositions[at2d(UNIT_KIND_COUNT, (iCell), (kind))]
+
+/// @brief Gets the index of a cell of a unit.
+/// @param grid in: the grid
+/// @param unit in: the index of the unit
+/// @param position in: the position of the cell in the unit, in range [0 ; SIZE[
+/// @return The index of the cell.
+/// @remark The position of a cell is its column number in its row, its row number in its column and its index from left to right then top to bottom in its block.
+#define grid_unitCellAt(grid, unit, position) (grid)._unitCells[at2d(grid_size(grid), (unit), (position))]
+
+/// @brief Gets the index of a peer of a cell.
+/// @param grid in: the grid
+/// @param iCell in: the index of the cell
+/// @param iPeer in: the index of the peer, in range [0 ; @ref grid_peerCount[
+/// @return The index of the peer cell.
+#define grid_peerAt(grid, iCell, iPeer) (grid)._peers[at2d(grid_peerCount(grid), (iCell), (iPeer))]
+
+/// @brief Gets the bitset of the values present in a unit.
+#define grid_unitValues(grid, unit) (&(grid)._unitValues[at2d(grid_wordCount(grid), (unit), 0)])
+
+/// @brief Gets the bitset of the positions of the cells of a unit that have a candidate.
+/// @param grid in: the grid
+/// @param unit in: the index of the unit
+/// @param candidate in: the candidate
+/// @return A pointer to the bitset of the positions in the unit of the cells having @p candidate (position @c p is stored at bit @c p).
+/// @remark Kept in sync with the candidates of the cells by @ref grid_cell_removeCandidate and @ref grid_cell_provideValue.
+#define grid_unitPositions(grid, unit, candidate) \
+    (&(grid)._unitPositions[at3d(grid_size(grid), grid_wordCount(grid), (unit), (candidate) - 1, 0)])
+
+/// @brief Removes a cell from the position bitsets of its 3 units for a candidate.
+#define grid_forgetCandidatePosition(grid, iCell, candidate)                                                    \
+    do {                                                                                                          \
+        for (tIntSize _kind = 0; _kind < UNIT_KIND_COUNT; _kind++) {                                              \
+            bitset_remove(grid_unitPositions(grid, grid_unitOf(grid, (iCell), _kind), (candidate)), grid_cellPosition(grid, (iCell), _kind)); \
+        }                                                                                                         \
     } while (0)
 
-/// @brief Gets the axis index (a row or column number) of the start of the block containing the given index.
-/// @param index in: an axis index (row or column number)
-/// @return The axis index of the start of the block containing the given index.
-#define grid_blockIndex(grid, index) (index - (index % (grid).N))
+/// @brief Adds a cell to the position bitsets of its 3 units for a candidate.
+#define grid_rememberCandidatePosition(grid, iCell, candidate)                                                   \
+    do {                                                                                                          \
+        for (tIntSize _kind = 0; _kind < UNIT_KIND_COUNT; _kind++) {                                              \
+            bitset_add(grid_unitPositions(grid, grid_unitOf(grid, (iCell), _kind), (candidate)), grid_cellPosition(grid, (iCell), _kind)); \
+        }                                                                                                         \
+    } while (0)
 
-/// @brief Check if a value can be added to the grid. Does not take candidates into account.
+/// @brief Marks the units containing a cell as dirty.
+#define grid_markUnitsDirty(grid, iCell)                                              \
+    do {                                                                              \
+        for (tIntSize _kind = 0; _kind < UNIT_KIND_COUNT; _kind++) {                  \
+            queue_push(&(grid)._dirtyUnits, grid_unitOf(grid, (iCell), _kind));       \
+        }                                                                             \
+    } while (0)
+
+/// @brief Gets the index of the block containing a cell.
 /// @param grid in: the grid
 /// @param row in: the cell's row
 /// @param column in: the cell's column
+/// @return The index of the block in range [0 ; SIZE[, blocks being numbered from left to right then top to bottom.
+/// @remark Prefer @ref grid_unitOf, which does not divide.
+#define grid_blockAt(grid, row, column) ((row) / grid_N(grid) * grid_N(grid) + (column) / grid_N(grid))
+
+/// @brief Defines whether a value is free or not at a position on the grid.
+#define grid_markValueFree(isFree, grid, iCell, value)                                        \
+    do {                                                                                      \
+        assert((iCell) < grid_cellCount(grid));                                               \
+        assert(1 <= (value) && (value) <= grid_size(grid));                                   \
+        for (tIntSize _kind = 0; _kind < UNIT_KIND_COUNT; _kind++) {                          \
+            tBitsetWord *_unitValues = grid_unitValues(grid, grid_unitOf(grid, (iCell), _kind)); \
+            if (isFree) {                                                                     \
+                bitset_remove(_unitValues, (value) - 1);                                      \
+            } else {                                                                          \
+                bitset_add(_unitValues, (value) - 1);                                         \
+            }                                                                                 \
+        }                                                                                     \
+    } while (0)
+
+/// @brief Gets a word of the set of values that can be added to a cell. Does not take candidates into account.
+/// @param grid in: the grid
+/// @param iCell in: the index of the cell
+/// @param word in: the index of the bitset word to get
+/// @return Word @p word of the bitset of values that are present neither in the row, nor in the column, nor in the block of the cell (value @c v is stored at bit @c v-1).
+// The set of possible values is the complement of the union of the values present in the 3 units of the cell.
+#define grid_cellPossibleValues(grid, iCell, word)                                  \
+    (~(grid_unitValues(grid, grid_unitOf(grid, (iCell), UK_row))[word]              \
+         | grid_unitValues(grid, grid_unitOf(grid, (iCell), UK_column))[word]       \
+         | grid_unitValues(grid, grid_unitOf(grid, (iCell), UK_block))[word])       \
+        & bitset_wordMask(grid_size(grid), (word)))
+
+/// @brief Check if a value can be added to the grid. Does not take candidates into account.
+/// @param grid in: the grid
+/// @param iCell in: the index of the cell
 /// @param value in: value to check
 /// @return Whether the value can be added to the grid at the given position.
 /// @remark According to the rules of Sudoku, a value can only be added to the grid when it is not already present in the row, in the column and in the block.
-// After running tests, it seems that the fastest access order is column, row, block.
 // This solutions is considerably faster than the naive alternative (iterating over cells)
-// But it comes at a price : we must make sure that the state of candidates in the grid and the "_is*Free" arrays are synchronized from the start of the resolution to the backtracking call.
+// But it comes at a price : we must make sure that the state of candidates in the grid and the "_unitValues" bitsets are synchronized from the start of the resolution to the backtracking call.
 // For this we use the grid_markValueFree macro
-#define grid_possible(grid, row, column, value)                     \
-    ((grid)._isColumnFree[at2d(grid_size(grid) + 1, (column), (value))] \
-        && (grid)._isRowFree[at2d(grid_size(grid) + 1, (row), (value))] \
-        && (grid)._isBlockFree[at3d((grid).N, grid_size(grid) + 1, (row) / (grid).N, (column) / (grid).N, (value))])
+#define grid_possible(grid, iCell, value) \
+    ((grid_cellPossibleValues(grid, iCell, ((value) - 1) / BITSET_WORD_BITS) & bitset_bitMask((value) - 1)) != 0)
 
 /// @brief Counts the number of possible values for a cell.
 /// @param grid in: the grid
-/// @param row in: the cell's row
-/// @param column in: the cell's column
+/// @param iCell in: the index of the cell
 /// @param outVarName Name of the variable to declare and assign the result to.
 /// @return The amount of values for which @ref grid_possible returns @c true.
-#define grid_cellPossibleValuesCount(grid, row, column, outVarName) \
-    tIntSize outVarName = 0;                                        \
-    for (tIntSize val = 1; val <= grid_size(grid); val++) {             \
-        outVarName += grid_possible((grid), (row), (column), val);  \
+#define grid_cellPossibleValuesCount(grid, iCell, outVarName)                     \
+    tIntSize outVarName = 0;                                                      \
+    for (tIntSize _word = 0; _word < grid_wordCount(grid); _word++) {             \
+        outVarName += word_popcount(grid_cellPossibleValues((grid), (iCell), _word)); \
     }
 
 tGrid grid_create(tIntN const N);
@@ -74,46 +239,151 @@ int grid_load(FILE *inStream, tGrid *g);
 /// @param outStream in: the file to write to
 void grid_write(tGrid const *grid, FILE *outStream);
 
+/// @brief Writes a grid on a single line of text.
+/// @param grid in: the grid to write
+/// @param outStream in: the file to write to
+/// @remark Each value is written in decimal with as many digits as the grid size, padded with zeros. Empty cells are written as 0. For a regular 9x9 grid, this is the usual 81-digit line.
+void grid_writeLine(tGrid const *grid, FILE *outStream);
+
 /// @brief Frees a grid.
 /// @param grid in/out: the grid to free
 void grid_free(tGrid *grid);
 
-/// @brief Removes a candidate from a cell of the grid and sets it as the cell's value if it's the last one.
+// Grid update functions
+// These are defined inline so that each solver kernel gets its own copy, specialized for its size factor (see kernel.h).
+
+/// @brief Removes a candidate from a cell of the grid.
 /// @param grid in/out: the grid
-/// @param row in: the cell's row
-/// @param column in: the cell's column
+/// @remark The cell and its units are queued as dirty. If it was the last candidate of the cell, the grid has a contradiction (see @ref tGrid.hasContradiction).
+/// @param iCell in: the index of the cell
 /// @param candidate in: the candidate to remove
 /// @return Whether the candidate has been removed.
-bool grid_cell_removeCandidate(tGrid *grid, tIntSize row, tIntSize column, tIntSize candidate);
+static inline bool grid_cell_removeCandidate(tGrid *grid, tIntSize2 iCell, tIntSize candidate) {
+    tBitsetWord *candidates = grid_candidates(*grid, iCell);
+
+    assert(1 <= candidate && candidate <= grid_size(*grid));
+
+    bool possible = bitset_has(candidates, candidate - 1);
+    if (possible) {
+        bitset_remove(candidates, candidate - 1);
+        grid->eliminationCount++;
+        grid_forgetCandidatePosition(*grid, iCell, candidate);
+        queue_push(&grid->_dirtyCells, iCell);
+        grid_markUnitsDirty(*grid, iCell);
+        // An empty cell without candidates cannot receive a value.
+        if (--grid_candidateCount(*grid, iCell) == 0) {
+            grid->hasContradiction = true;
+        }
+    }
+
+    return possible;
+}
 
 /// @brief Defines the value of a cell and removes all its candidates.
 /// @param grid in/out: the grid
-/// @param row in: the cell's row
-/// @param column in: the cell's column
+/// @remark The units of the cell are queued as dirty and the cell is queued as placed.
+/// @param iCell in: the index of the cell
 /// @param candidate in: the value to provide to the cell
-void grid_cell_provideValue(tGrid *grid, tIntSize row, tIntSize column, tIntSize value);
+static inline void grid_cell_provideValue(tGrid *grid, tIntSize2 iCell, tIntSize value) {
+    assert(grid_possible(*grid, iCell, value));
+
+    assert(1 <= value && value <= grid_size(*grid));
+    assert(grid_value(*grid, iCell) == 0);
 
-/// @brief Removes a candidate from all cells of a row.
+    grid_value(*grid, iCell) = value;
+    grid_candidateCount(*grid, iCell) = 0;
+    bitset_forEach(grid_candidates(*grid, iCell), grid_wordCount(*grid), bit) {
+        grid_forgetCandidatePosition(*grid, iCell, bit + 1);
+    }
+    memset(grid_candidates(*grid, iCell), 0, sizeof *grid->_candidates * grid_wordCount(*grid));
+    grid_markValueFree(false, *grid, iCell, value);
+    grid_markUnitsDirty(*grid, iCell);
+    queue_push(&grid->_placedCells, iCell);
+}
+
+/// @brief Removes a candidate from the cells of a word of the positions of a unit.
 /// @param grid in/out: the grid
-/// @param row in: the row
+/// @param unit in: the index of the unit
 /// @param candidate in: the candidate to remove
-/// @return Whether progress has been made.
-bool grid_removeCandidateFromRow(tGrid *grid, tIntSize row, tIntSize candidate);
+/// @param word in: the index of the word of the position bitsets of the unit
+/// @param singles out: the positions in word @p word of the cells left with a single candidate
+/// @return The positions in word @p word of the cells that lost the candidate.
+/// @remark Only the cells that have the candidate are visited, and the word of the position bitset of the unit is cleared at once.
+/// @remark A cell that loses its last candidate is a contradiction, like in @ref grid_cell_removeCandidate. The dirty queues are left to the caller, which knows from the returned masks which cells need further work.
+static inline tBitsetWord grid_unit_removeCandidateWord(tGrid *grid, tIntSize2 unit, tIntSize candidate, tIntSize word, tBitsetWord *singles) {
+    assert(1 <= candidate && candidate <= grid_size(*grid));
+
+    tBitsetWord *positions = &grid_unitPositions(*grid, unit, candidate)[word];
+    tBitsetWord const changed = *positions;
+    *positions = 0;
+    *singles = 0;
+    grid->eliminationCount += word_popcount(changed);
 
-/// @brief Removes a candidate from all cells of a column.
+    for (tBitsetWord remaining = changed; remaining != 0; remaining &= remaining - 1) {
+        tIntSize const position = word * BITSET_WORD_BITS + word_ctz(remaining);
+        tIntSize2 const iCell = grid_unitCellAt(*grid, unit, position);
+
+        bitset_remove(grid_candidates(*grid, iCell), candidate - 1);
+        // The positions of the cell in the other 2 units
+        for (tIntSize kind = 0; kind < UNIT_KIND_COUNT; kind++) {
+            tIntSize2 const otherUnit = grid_unitOf(*grid, iCell, kind);
+            if (otherUnit != unit) {
+                bitset_remove(grid_unitPositions(*grid, otherUnit, candidate), grid_cellPosition(*grid, iCell, kind));
+            }
+        }
+
+        switch (--grid_candidateCount(*grid, iCell)) {
+        case 1:
+            *singles |= bitset_bitMask(position);
+            break;
+        case 0:
+            grid->hasContradiction = true;
+            break;
+        }
+    }
+
+    return changed;
+}
+
+/// @brief Removes a candidate from all cells of a unit.
 /// @param grid in/out: the grid
-/// @param column in: the column
+/// @param unit in: the index of the unit
 /// @param candidate in: the candidate to remove
 /// @return Whether progress has been made.
-bool grid_removeCandidateFromColumn(tGrid *grid, tIntSize column, tIntSize candidate);
+/// @remark The units of the cells that lost the candidate are queued as dirty. Of these cells, only the ones left with a single candidate are queued as dirty, since the naked singleton is the only cell technique.
+static inline bool grid_removeCandidateFromUnit(tGrid *grid, tIntSize2 unit, tIntSize candidate) {
+    bool progress = false;
+    for (tIntSize word = 0; word < grid_wordCount(*grid); word++) {
+        tBitsetWord singles;
+        tBitsetWord const changed = grid_unit_removeCandidateWord(grid, unit, candidate, word, &singles);
+        if (changed == 0) continue;
 
-/// @brief Removes a candidate from all cells of a block.
+        progress = true;
+        for (tBitsetWord remaining = singles; remaining != 0; remaining &= remaining - 1) {
+            queue_push(&grid->_dirtyCells, grid_unitCellAt(*grid, unit, word * BITSET_WORD_BITS + word_ctz(remaining)));
+        }
+        for (tBitsetWord remaining = changed; remaining != 0; remaining &= remaining - 1) {
+            grid_markUnitsDirty(*grid, grid_unitCellAt(*grid, unit, word * BITSET_WORD_BITS + word_ctz(remaining)));
+        }
+    }
+    return progress;
+}
+
+/// @brief Removes a candidate from all the peers of a cell.
 /// @param grid in/out: the grid
-/// @param row in: the row of a cell in the block
-/// @param column in: the column of a cell in the block
+/// @param iCell in: the index of the cell. Must not have the candidate.
 /// @param candidate in: the candidate to remove
 /// @return Whether progress has been made.
-bool grid_removeCandidateFromBlock(tGrid *grid, tIntSize row, tIntSize column, tIntSize candidate);
+/// @remark The peers of a cell are the other cells of its 3 units. As the cell does not have the candidate, clearing it from the 3 units only affects the peers.
+static inline bool grid_removeCandidateFromPeers(tGrid *grid, tIntSize2 iCell, tIntSize candidate) {
+    assert(!bitset_has(grid_candidates(*grid, iCell), candidate - 1));
+
+    bool progress = false;
+    for (tIntSize kind = 0; kind < UNIT_KIND_COUNT; kind++) {
+        progress |= grid_removeCandidateFromUnit(grid, grid_unitOf(*grid, iCell, kind), candidate);
+    }
+    return progress;
+}
 
 // Grid display functions
 
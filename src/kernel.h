@@ -0,0 +1,36 @@
+/** @file
+ * @brief Solver kernels header
+ * @author 5cover, Matteo-K
+ *
+ * The solver (resolution.c) is compiled once generically, and once per common size factor as a kernel.
+ * A kernel is a translation unit that defines @ref KERNEL_N before including resolution.c (see resolution_n3.c).
+ * In a kernel, @c grid_N and @c grid_size are compile-time constants, so loop bounds, block index divisions and the number of candidate bitset words are known to the compiler.
+ * The functions of a kernel have internal linkage, except its entry point @c resolution_solve_n<N>.
+ */
+
+#ifndef KERNEL_H
+#define KERNEL_H
+
+/// @brief Lists the size factors that have a specialized kernel.
+/// @param X Macro to expand for each size factor.
+#define KERNEL_FOREACH_N(X) X(2) X(3) X(4) X(5)
+
+/// @brief Linkage of the solver functions.
+/// @remark Kernels are static so each kernel gets its own copy of every function without name collisions.
+#ifdef KERNEL_N
+#ifdef __GNUC__
+#define KERNEL_LINKAGE static __attribute__((unused))
+#else
+#define KERNEL_LINKAGE static
+#endif // __GNUC__
+#else
+#define KERNEL_LINKAGE
+#endif // KERNEL_N
+
+#define KERNEL_CONCAT_(a, b) a##b
+#define KERNEL_CONCAT(a, b) KERNEL_CONCAT_(a, b)
+
+/// @brief Gets the name of the entry point of the kernel for a size factor.
+#define kernel_solveName(n) KERNEL_CONCAT(resolution_solve_n, n)
+
+#endif // KERNEL_H
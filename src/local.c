@@ -0,0 +1,323 @@
+/** @file
+ * @brief Local search engine implementation
+ * @author 5cover, Matteo-K
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include "bitset.h"
+#include "grid.h"
+#include "local.h"
+#include "memdbg.h"
+#include "resolution.h"
+
+/// @brief Real: factor the temperature is multiplied by after each chain of moves.
+#define LOCAL_COOLING 0.99
+
+/// @brief Integer: number of moves sampled to choose the initial temperature.
+#define LOCAL_SAMPLE_MOVES 200
+
+/// @brief Gets the counts of the values of a row.
+#define local_rowCounts(search, grid, row) (&(search)->_rowCounts[at2d(grid_size(grid), (row), 0)])
+
+/// @brief Gets the counts of the values of a column.
+#define local_columnCounts(search, grid, column) (&(search)->_columnCounts[at2d(grid_size(grid), (column), 0)])
+
+/// @brief Draws a pseudo-random number (xorshift64*).
+/// @param search in/out: the search, whose generator state advances
+/// @return The number.
+static inline uint64_t local_random(tLocalSearch *search) {
+    uint64_t x = search->_random;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    search->_random = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/// @brief Draws a pseudo-random number below a bound.
+/// @param search in/out: the search
+/// @param bound in: the bound. Must not be 0.
+/// @return The number, in range [0 ; @p bound[.
+static inline uint32_t local_randomBelow(tLocalSearch *search, uint32_t bound) {
+    return (uint32_t)(((local_random(search) >> 32) * bound) >> 32);
+}
+
+/// @brief Computes the change of the number of duplicates of two lines when a value of the first line and another value of the second line trade places.
+/// @param countsA in: the counts of the values of the first line
+/// @param countsB in: the counts of the values of the second line
+/// @param iValueA in: the index of the value that leaves the first line for the second
+/// @param iValueB in: the index of the value that leaves the second line for the first
+/// @return The change of the number of duplicates, in range [-4 ; 4].
+static inline int local_lineDelta(tIntSize const *countsA, tIntSize const *countsB, tIntSize iValueA, tIntSize iValueB) {
+    return (countsA[iValueB] >= 1) - (countsA[iValueA] >= 2) + (countsB[iValueA] >= 1) - (countsB[iValueB] >= 2);
+}
+
+/// @brief Makes a value of a line and another value of a second line trade places in the counts of the lines.
+static inline void local_moveValues(tIntSize *countsA, tIntSize *countsB, tIntSize iValueA, tIntSize iValueB) {
+    countsA[iValueA]--;
+    countsA[iValueB]++;
+    countsB[iValueB]--;
+    countsB[iValueA]++;
+}
+
+/// @brief Draws a move: two free cells of a block.
+/// @param search in/out: the search. Must have a movable block.
+/// @param grid in: the grid
+/// @param iCellA out: the first cell
+/// @param iCellB out: the second cell
+/// @return Whether each cell has the value of the other as a candidate, so that they can swap their values.
+static inline bool local_drawMove(tLocalSearch *search, tGrid const *grid, tIntSize2 *iCellA, tIntSize2 *iCellB) {
+    tIntSize const block = search->_movableBlocks[local_randomBelow(search, search->_movableBlockCount)];
+    tIntSize2 const start = search->_blockStarts[block];
+    tIntSize2 const freeCount = search->_blockStarts[block + 1] - start;
+
+    tIntSize2 const i = local_randomBelow(search, freeCount);
+    tIntSize2 j = local_randomBelow(search, freeCount - 1);
+    j += j >= i;
+    *iCellA = search->_freeCells[start + i];
+    *iCellB = search->_freeCells[start + j];
+
+    return bitset_has(grid_candidates(*grid, *iCellA), grid_value(*grid, *iCellB) - 1)
+        && bitset_has(grid_candidates(*grid, *iCellB), grid_value(*grid, *iCellA) - 1);
+}
+
+/// @brief Computes the change of the cost if two cells of a block swapped their values.
+/// @param search in: the search
+/// @param grid in: the grid
+/// @param iCellA in: the first cell
+/// @param iCellB in: the second cell
+/// @return The change of the cost, in range [-@ref LOCAL_MAX_DELTA ; @ref LOCAL_MAX_DELTA].
+static inline int local_swapDelta(tLocalSearch const *search, tGrid const *grid, tIntSize2 iCellA, tIntSize2 iCellB) {
+    tIntSize const iValueA = grid_value(*grid, iCellA) - 1, iValueB = grid_value(*grid, iCellB) - 1;
+    tIntSize const rowA = iCellA / grid_size(*grid), rowB = iCellB / grid_size(*grid);
+    tIntSize const columnA = iCellA % grid_size(*grid), columnB = iCellB % grid_size(*grid);
+
+    // A line that holds both cells keeps its values.
+    int delta = 0;
+    if (rowA != rowB) {
+        delta += local_lineDelta(local_rowCounts(search, *grid, rowA), local_rowCounts(search, *grid, rowB), iValueA, iValueB);
+    }
+    if (columnA != columnB) {
+        delta += local_lineDelta(local_columnCounts(search, *grid, columnA), local_columnCounts(search, *grid, columnB), iValueA, iValueB);
+    }
+    return delta;
+}
+
+/// @brief Swaps the values of two cells of a block.
+/// @param search in/out: the search
+/// @param grid in/out: the grid
+/// @param iCellA in: the first cell
+/// @param iCellB in: the second cell
+static inline void local_swap(tLocalSearch *search, tGrid *grid, tIntSize2 iCellA, tIntSize2 iCellB) {
+    tIntSize const iValueA = grid_value(*grid, iCellA) - 1, iValueB = grid_value(*grid, iCellB) - 1;
+    tIntSize const rowA = iCellA / grid_size(*grid), rowB = iCellB / grid_size(*grid);
+    tIntSize const columnA = iCellA % grid_size(*grid), columnB = iCellB % grid_size(*grid);
+
+    if (rowA != rowB) {
+        local_moveValues(local_rowCounts(search, *grid, rowA), local_rowCounts(search, *grid, rowB), iValueA, iValueB);
+    }
+    if (columnA != columnB) {
+        local_moveValues(local_columnCounts(search, *grid, columnA), local_columnCounts(search, *grid, columnB), iValueA, iValueB);
+    }
+    grid_value(*grid, iCellA) = iValueB + 1;
+    grid_value(*grid, iCellB) = iValueA + 1;
+}
+
+/// @brief Sets the temperature, and the probabilities of accepting the moves that increase the cost.
+/// @param search in/out: the search
+/// @param temperature in: the temperature. Must be positive.
+static inline void local_setTemperature(tLocalSearch *search, double temperature) {
+    search->_temperature = temperature;
+    for (int delta = 1; delta <= LOCAL_MAX_DELTA; delta++) {
+        search->_acceptances[delta] = (uint64_t)(exp(-delta / temperature) * 4294967296.0);
+    }
+}
+
+/// @brief Finds an augmenting path from a free cell of a block, through the values not visited yet.
+/// @param search in/out: the search
+/// @param grid in: the grid
+/// @param iCell in: the cell
+/// @return Whether the path was found. If so, the cell and the cells along the path are matched to new values.
+static bool local_augment(tLocalSearch *search, tGrid const *grid, tIntSize2 iCell) {
+    // Start from a random candidate, so that each filling is different.
+    unsigned const offset = local_randomBelow(search, grid_size(*grid));
+    for (unsigned i = 0; i < grid_size(*grid); i++) {
+        tIntSize const iValue = (tIntSize)((offset + i) % grid_size(*grid));
+        if (!bitset_has(grid_candidates(*grid, iCell), iValue) || search->_visits[iValue] == search->_stamp) continue;
+        search->_visits[iValue] = search->_stamp;
+
+        if (search->_matches[iValue] == LOCAL_NO_CELL || local_augment(search, grid, search->_matches[iValue])) {
+            search->_matches[iValue] = iCell;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Fills the free cells of each block with the values the block misses, each cell with one of its candidates.
+/// @param search in/out: the search
+/// @param grid in/out: the grid
+/// @return Whether each block could be filled. If not, the grid has no solution.
+/// @remark The candidates of a block are matched to its free cells in a random order, so that each filling is different.
+static bool local_fill(tLocalSearch *search, tGrid *grid) {
+    for (tIntSize block = 0; block < grid_size(*grid); block++) {
+        tIntSize2 *freeCells = &search->_freeCells[search->_blockStarts[block]];
+        tIntSize2 const freeCount = search->_blockStarts[block + 1] - search->_blockStarts[block];
+
+        for (tIntSize2 i = freeCount; i > 1; i--) {
+            tIntSize2 const j = local_randomBelow(search, i);
+            tIntSize2 const tmp = freeCells[i - 1];
+            freeCells[i - 1] = freeCells[j];
+            freeCells[j] = tmp;
+        }
+
+        for (tIntSize iValue = 0; iValue < grid_size(*grid); iValue++) {
+            search->_matches[iValue] = LOCAL_NO_CELL;
+        }
+        for (tIntSize2 i = 0; i < freeCount; i++) {
+            search->_stamp++;
+            if (!local_augment(search, grid, freeCells[i])) return false;
+        }
+        for (tIntSize iValue = 0; iValue < grid_size(*grid); iValue++) {
+            if (search->_matches[iValue] != LOCAL_NO_CELL) grid_value(*grid, search->_matches[iValue]) = iValue + 1;
+        }
+    }
+
+    // Count the values of the lines, and their duplicates.
+    size_t const countsLength = (size_t)grid_size(*grid) * grid_size(*grid);
+    memset(search->_rowCounts, 0, sizeof *search->_rowCounts * countsLength);
+    memset(search->_columnCounts, 0, sizeof *search->_columnCounts * countsLength);
+    for (tIntSize2 iCell = 0; iCell < grid_cellCount(*grid); iCell++) {
+        tIntSize const iValue = grid_value(*grid, iCell) - 1;
+        local_rowCounts(search, *grid, iCell / grid_size(*grid))[iValue]++;
+        local_columnCounts(search, *grid, iCell % grid_size(*grid))[iValue]++;
+    }
+    search->_cost = 0;
+    for (size_t i = 0; i < countsLength; i++) {
+        search->_cost += (search->_rowCounts[i] > 1 ? search->_rowCounts[i] - 1 : 0)
+                       + (search->_columnCounts[i] > 1 ? search->_columnCounts[i] - 1 : 0);
+    }
+
+    return true;
+}
+
+/// @brief Heats a filling up: chooses the initial temperature from the standard deviation of the cost changes of random moves.
+/// @param search in/out: the search
+/// @param grid in: the grid
+static void local_heat(tLocalSearch *search, tGrid const *grid) {
+    double sum = 0, sumOfSquares = 0;
+    unsigned count = 0;
+    for (unsigned i = 0; i < LOCAL_SAMPLE_MOVES && search->_movableBlockCount > 0; i++) {
+        tIntSize2 iCellA, iCellB;
+        if (!local_drawMove(search, grid, &iCellA, &iCellB)) continue;
+        int const delta = local_swapDelta(search, grid, iCellA, iCellB);
+        sum += delta;
+        sumOfSquares += delta * delta;
+        count++;
+    }
+    double const variance = count > 1 ? (sumOfSquares - sum * sum / count) / (count - 1) : 0;
+    local_setTemperature(search, variance > 0 ? sqrt(variance) : 1);
+
+    search->_bestCost = search->_cost;
+    search->_chainMoves = 0;
+    search->_stallCount = 0;
+}
+
+size_t local_scratchSize(tGrid const *grid) {
+    // Free cells + block starts + movable blocks + row and column counts + matches + visits
+    return arena_size(sizeof(tIntSize2) * grid_cellCount(*grid))
+         + arena_size(sizeof(tIntSize2) * (grid_size(*grid) + 1))
+         + arena_size(sizeof(tIntSize) * grid_size(*grid))
+         + 2 * arena_size(sizeof(tIntSize) * grid_size(*grid) * grid_size(*grid))
+         + arena_size(sizeof(tIntSize2) * grid_size(*grid))
+         + arena_size(sizeof(uint32_t) * grid_size(*grid));
+}
+
+void local_start(tLocalSearch *search, tGrid *grid, uint64_t seed) {
+    search->_freeCells = arena_array_alloc(&grid->scratch, search->_freeCells, grid_cellCount(*grid));
+    search->_blockStarts = arena_array_alloc(&grid->scratch, search->_blockStarts, grid_size(*grid) + 1);
+    search->_movableBlocks = arena_array_alloc(&grid->scratch, search->_movableBlocks, grid_size(*grid));
+    search->_rowCounts = arena_array_alloc(&grid->scratch, search->_rowCounts, grid_size(*grid) * grid_size(*grid));
+    search->_columnCounts = arena_array_alloc(&grid->scratch, search->_columnCounts, grid_size(*grid) * grid_size(*grid));
+    search->_matches = arena_array_alloc(&grid->scratch, search->_matches, grid_size(*grid));
+    search->_visits = arena_array_alloc(&grid->scratch, search->_visits, grid_size(*grid));
+    memset(search->_visits, 0, sizeof *search->_visits * grid_size(*grid));
+    search->_stamp = 0;
+    search->stats = (tSearchStats) { 0 };
+
+    // Mix the seed (splitmix64), so that close seeds give unrelated sequences. The state of xorshift must not be 0.
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    search->_random = z != 0 ? z : 1;
+
+    // Collect the free cells, block by block.
+    tIntSize2 freeCount = 0;
+    search->_movableBlockCount = 0;
+    search->_chainLength = 1;
+    for (tIntSize block = 0; block < grid_size(*grid); block++) {
+        search->_blockStarts[block] = freeCount;
+        tIntSize2 const unit = grid_unit(*grid, UK_block, block);
+        for (tIntSize position = 0; position < grid_size(*grid); position++) {
+            tIntSize2 const iCell = grid_unitCellAt(*grid, unit, position);
+            if (grid_value(*grid, iCell) == 0) search->_freeCells[freeCount++] = iCell;
+        }
+
+        // A chain tries about as many moves as there are pairs of free cells in the blocks.
+        tIntSize2 const blockFreeCount = freeCount - search->_blockStarts[block];
+        if (blockFreeCount >= 2) search->_movableBlocks[search->_movableBlockCount++] = block;
+        search->_chainLength += (uint64_t)blockFreeCount * blockFreeCount;
+    }
+    search->_blockStarts[grid_size(*grid)] = freeCount;
+
+    search->_unsatisfiable = !local_fill(search, grid);
+    if (!search->_unsatisfiable) local_heat(search, grid);
+}
+
+tBacktrackingStatus local_run(tLocalSearch *search, tGrid *grid, uint64_t nodeBudget) {
+    if (search->_unsatisfiable) return BS_exhausted;
+
+    uint32_t restartCount = 0;
+
+    while (search->_cost > 0) {
+        if (nodeBudget == 0) return BS_paused;
+
+        // Cool down after each chain, and restart from another filling when the cost stalls.
+        if (++search->_chainMoves >= search->_chainLength) {
+            search->_chainMoves = 0;
+            local_setTemperature(search, search->_temperature * LOCAL_COOLING);
+            if (++search->_stallCount >= LOCAL_STALL_CHAINS) {
+                if (restartCount++ == LOCAL_MAX_RESTARTS) return BS_paused;
+                search->stats.backtrackCount++;
+                // The blocks could be filled once, so they can be filled in any order.
+                bool const filled = local_fill(search, grid);
+                assert(filled);
+                (void)filled;
+                local_heat(search, grid);
+                continue;
+            }
+        }
+
+        search->stats.nodeCount++;
+        nodeBudget -= nodeBudget != BACKTRACKING_NO_LIMIT;
+
+        tIntSize2 iCellA, iCellB;
+        if (search->_movableBlockCount == 0 || !local_drawMove(search, grid, &iCellA, &iCellB)) continue;
+
+        int const delta = local_swapDelta(search, grid, iCellA, iCellB);
+        if (delta > 0 && local_random(search) >> 32 >= search->_acceptances[delta]) continue;
+
+        local_swap(search, grid, iCellA, iCellB);
+        search->_cost += delta;
+        if (search->_cost < search->_bestCost) {
+            search->_bestCost = search->_cost;
+            search->_stallCount = 0;
+        }
+    }
+
+    return BS_solved;
+}
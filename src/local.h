@@ -0,0 +1,48 @@
+/** @file
+ * @brief Local search engine header
+ * @author 5cover, Matteo-K
+ *
+ * The empty cells of each block are filled with the values the block misses, so that each block holds each value once, and each cell holds one of its candidates.
+ * Simulated annealing then swaps the values of two cells of a block, to bring down the number of duplicate values in the rows and the columns. A swap that lowers it is always accepted, and one that raises it is accepted with a probability that decreases with the temperature, which lowers after each chain of moves.
+ * When the lowest cost has not improved for a number of chains, the search restarts from another filling. The moves are drawn from a seeded pseudo-random number generator, so a search is reproducible.
+ * Unlike the other engines, the local search is incomplete: it cannot prove that a grid has no solution, unless a block cannot be filled at all.
+ */
+
+#ifndef LOCAL_H
+#define LOCAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "types.h"
+
+/// @brief Integer: free cell matched to a value that no free cell is matched to yet.
+#define LOCAL_NO_CELL UINT_LEAST32_MAX
+
+/// @brief Integer: number of chains without improvement of the lowest cost after which the search restarts.
+#define LOCAL_STALL_CHAINS 40
+
+/// @brief Integer: number of restarts after which a run gives up.
+#define LOCAL_MAX_RESTARTS 1000
+
+/// @brief Computes the size of the scratch arena needed by a search.
+/// @param grid in: the grid. Only its size factor is used.
+/// @return The number of bytes to reserve in the scratch arena of the grid.
+size_t local_scratchSize(tGrid const *grid);
+
+/// @brief Starts a search: fills the empty cells of each block with the values the block misses.
+/// @param search out: the search
+/// @param grid in/out: the grid. Its candidates must be consistent with its values. The state of the search is carved from its scratch arena.
+/// @param seed in: the seed of the pseudo-random number generator
+void local_start(tLocalSearch *search, tGrid *grid, uint64_t seed);
+
+/// @brief Runs a search until it ends or a number of moves have been tried.
+/// @param search in/out: the search, started with @ref local_start
+/// @param grid in/out: the grid
+/// @param nodeBudget in: the maximum number of moves, or @ref BACKTRACKING_NO_LIMIT
+/// @return @ref BS_solved if the values of the grid are a solution, @ref BS_exhausted if a block could not be filled, so the grid has no solution, or @ref BS_paused if the budget ran out or the search restarted @ref LOCAL_MAX_RESTARTS times. A paused search is resumed by calling this function again.
+/// @remark The candidates of the grid are not updated.
+tBacktrackingStatus local_run(tLocalSearch *search, tGrid *grid, uint64_t nodeBudget);
+
+#endif // LOCAL_H
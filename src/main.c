@@ -4,22 +4,70 @@
  */
 
 #include <getopt.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
+#include "dlx.h"
 #include "grid.h"
 #include "memdbg.h"
 #include "resolution.h"
+#include "sat.h"
 #include "tCell.h"
 
 static tGrid gs_grid; // Automatically zero-initialized
+static tDlx gs_dlx;   // Automatically zero-initialized
+
+/// @brief Names of the techniques on the command line, indexed by @ref tTechnique.
+static char const *const gs_techniqueNames[TECHNIQUE_COUNT] = {
+    [TE_lockedCandidates] = "locked",
+    [TE_nakedSubset] = "naked",
+    [TE_hiddenSubset] = "hidden",
+    [TE_fish] = "fish",
+};
+
+/// @brief Writes the solutions streamed by an enumeration.
+typedef struct {
+    /// @brief Number of solutions left to skip before one is written.
+    uint64_t skipCount;
+    /// @brief Whether the solutions are written in the Sud format instead of one line of text each.
+    bool binary;
+} tSolutionWriter;
 
 void perform_emergencyMemoryCleanup(void) {
-    // It's always safe to call grid_free since the pointers inside tGrid and tCell are always either NULL or valid, thanks to static member auto initialization and grid_create.
+    // It's always safe to call grid_free and dlx_free since the pointers inside tGrid, tCell and tDlx are always either NULL or valid, thanks to static member auto initialization, grid_create and dlx_create.
     grid_free(&gs_grid);
+    dlx_free(&gs_dlx);
+}
+
+/// @brief Writes a solution streamed by an enumeration, unless it is skipped.
+/// @param grid in: the grid, which holds the solution
+/// @param context in/out: the @ref tSolutionWriter
+static void write_solution(tGrid const *grid, void *context) {
+    tSolutionWriter *writer = context;
+    if (writer->skipCount > 0) {
+        writer->skipCount--;
+    } else if (writer->binary) {
+        grid_write(grid, stdout);
+    } else {
+        grid_writeLine(grid, stdout);
+    }
+}
+
+/// @brief Parses the integer argument of an option.
+/// @param arg in: the argument
+/// @param min in: the minimum value of the integer
+/// @param value out: assigned to the integer
+/// @return Whether @p arg is a decimal integer not less than @p min.
+static bool parse_count(char const *arg, uint64_t min, uint64_t *value) {
+    char *end;
+    unsigned long long const count = strtoull(arg, &end, 10);
+    if (*arg == '\0' || *end != '\0' || *arg == '-' || count < min) return false;
+    *value = count;
+    return true;
 }
 
 static void print_help(void) {
@@ -34,13 +82,40 @@ static void print_help(void) {
     puts("");
     puts("-s\t solve the grid");
     puts("-b\t binary (.sud) output");
+    puts("--stats\t print the technique and search statistics to standard error");
+    puts("--engine=ENGINE\t engine that solves the grid once the techniques stall: search (default), dlx (Dancing Links), sat (CDCL SAT solver) or local (simulated annealing)");
+    puts("--seed=K\t seed of the pseudo-random moves of the local engine (default 1)");
+    puts("--search=ALGORITHM\t search used once the techniques stall: backtracking or forward-checking (default)");
+    puts("--branch=STRATEGY\t how forward checking undoes assumptions: snapshot, trail or auto (default)");
+    puts("--subsets=K\t maximum size of the naked and hidden subsets searched (default 3, 1 disables them)");
+    puts("--fish=K\t maximum size of the fish searched: 2 for X-Wing, 3 for Swordfish, 4 for Jellyfish (default 4, 1 disables them)");
+    puts("--plan=LIST\t comma-separated techniques to run once the singletons stall, among locked, naked, hidden and fish (default: all, in this order)");
+    puts("--fixed-plan\t run the techniques in the order of the plan instead of adapting it to their measured yield");
+    puts("--count[=K]\t print the number of solutions of the grid instead of the grid, stopping at K (default: all)");
+    puts("--all\t write every solution of the grid as soon as it is found, one line of digits each (Sud format with -b). Searches with backtracking by default");
+    puts("--limit=K\t with --all, stop after writing K solutions");
+    puts("--skip=K\t with --all, skip the first K solutions");
+    puts("--dimacs\t write the CNF encoding of the grid the sat engine solves, once the techniques stall, in DIMACS format instead of solving it");
     puts("--help\t print this help and exit");
     puts("");
     puts("This is public domain software. Compiled on " __DATE__ ".");
 }
 
 int main(int argc, char **argv) {
-    bool opt_solve = false, opt_binary = false;
+    bool opt_solve = false, opt_binary = false, opt_stats = false, opt_count = false, opt_all = false, opt_search = false, opt_dimacs = false;
+    uint64_t opt_limit = SOLUTION_NO_LIMIT;
+    tSolutionWriter writer = { .skipCount = 0 };
+    tSolveOptions options = {
+        .search = SA_forwardChecking,
+        .branch = BR_auto,
+        .subsetMaxSize = SUBSET_DEFAULT_MAX_SIZE,
+        .fishMaxSize = FISH_DEFAULT_MAX_SIZE,
+        .plan = { TE_lockedCandidates, TE_nakedSubset, TE_hiddenSubset, TE_fish },
+        .planLength = TECHNIQUE_COUNT,
+        .adaptivePlan = true,
+        .solutionLimit = 1,
+        .seed = LOCAL_DEFAULT_SEED,
+    };
 
     // Parse command-line options
     {
@@ -51,6 +126,90 @@ int main(int argc, char **argv) {
                 .flag = NULL,
                 .val = 'h',
             },
+            (struct option) {
+                .name = "stats",
+                .has_arg = 0,
+                .flag = NULL,
+                .val = 'S',
+            },
+            (struct option) {
+                .name = "engine",
+                .has_arg = 1,
+                .flag = NULL,
+                .val = 'G',
+            },
+            (struct option) {
+                .name = "search",
+                .has_arg = 1,
+                .flag = NULL,
+                .val = 'A',
+            },
+            (struct option) {
+                .name = "branch",
+                .has_arg = 1,
+                .flag = NULL,
+                .val = 'B',
+            },
+            (struct option) {
+                .name = "subsets",
+                .has_arg = 1,
+                .flag = NULL,
+                .val = 'K',
+            },
+            (struct option) {
+                .name = "fish",
+                .has_arg = 1,
+                .flag = NULL,
+                .val = 'F',
+            },
+            (struct option) {
+                .name = "plan",
+                .has_arg = 1,
+                .flag = NULL,
+                .val = 'P',
+            },
+            (struct option) {
+                .name = "fixed-plan",
+                .has_arg = 0,
+                .flag = NULL,
+                .val = 'X',
+            },
+            (struct option) {
+                .name = "count",
+                .has_arg = 2,
+                .flag = NULL,
+                .val = 'C',
+            },
+            (struct option) {
+                .name = "all",
+                .has_arg = 0,
+                .flag = NULL,
+                .val = 'E',
+            },
+            (struct option) {
+                .name = "limit",
+                .has_arg = 1,
+                .flag = NULL,
+                .val = 'L',
+            },
+            (struct option) {
+                .name = "skip",
+                .has_arg = 1,
+                .flag = NULL,
+                .val = 'I',
+            },
+            (struct option) {
+                .name = "seed",
+                .has_arg = 1,
+                .flag = NULL,
+                .val = 'R',
+            },
+            (struct option) {
+                .name = "dimacs",
+                .has_arg = 0,
+                .flag = NULL,
+                .val = 'D',
+            },
             { 0 }
         };
 
@@ -63,6 +222,122 @@ int main(int argc, char **argv) {
             case 'b':
                 opt_binary = true;
                 break;
+            case 'S':
+                opt_stats = true;
+                break;
+            case 'G':
+                if (strcmp(optarg, "search") == 0) {
+                    options.engine = EN_search;
+                } else if (strcmp(optarg, "dlx") == 0) {
+                    options.engine = EN_dancingLinks;
+                } else if (strcmp(optarg, "sat") == 0) {
+                    options.engine = EN_sat;
+                } else if (strcmp(optarg, "local") == 0) {
+                    options.engine = EN_local;
+                } else {
+                    fprintf(stderr, PROGRAM_NAME ": unknown engine '%s'\n", optarg);
+                    return EXIT_INVALID_ARG;
+                }
+                break;
+            case 'A':
+                opt_search = true;
+                if (strcmp(optarg, "backtracking") == 0) {
+                    options.search = SA_backtracking;
+                } else if (strcmp(optarg, "forward-checking") == 0) {
+                    options.search = SA_forwardChecking;
+                } else {
+                    fprintf(stderr, PROGRAM_NAME ": unknown search '%s'\n", optarg);
+                    return EXIT_INVALID_ARG;
+                }
+                break;
+            case 'B':
+                if (strcmp(optarg, "auto") == 0) {
+                    options.branch = BR_auto;
+                } else if (strcmp(optarg, "snapshot") == 0) {
+                    options.branch = BR_snapshot;
+                } else if (strcmp(optarg, "trail") == 0) {
+                    options.branch = BR_trail;
+                } else {
+                    fprintf(stderr, PROGRAM_NAME ": unknown branch strategy '%s'\n", optarg);
+                    return EXIT_INVALID_ARG;
+                }
+                break;
+            case 'K': {
+                char *end;
+                unsigned long const maxSize = strtoul(optarg, &end, 10);
+                if (*optarg == '\0' || *end != '\0' || maxSize < 1 || maxSize > UINT_LEAST16_MAX) {
+                    fprintf(stderr, PROGRAM_NAME ": invalid subset size '%s'\n", optarg);
+                    return EXIT_INVALID_ARG;
+                }
+                options.subsetMaxSize = (tIntSize)maxSize;
+                break;
+            }
+            case 'F': {
+                char *end;
+                unsigned long const maxSize = strtoul(optarg, &end, 10);
+                if (*optarg == '\0' || *end != '\0' || maxSize < 1 || maxSize > UINT_LEAST16_MAX) {
+                    fprintf(stderr, PROGRAM_NAME ": invalid fish size '%s'\n", optarg);
+                    return EXIT_INVALID_ARG;
+                }
+                options.fishMaxSize = (tIntSize)maxSize;
+                break;
+            }
+            case 'P':
+                options.planLength = 0;
+                for (char *name = strtok(optarg, ","); name != NULL; name = strtok(NULL, ",")) {
+                    int technique = 0;
+                    while (technique < TECHNIQUE_COUNT && strcmp(name, gs_techniqueNames[technique]) != 0) {
+                        technique++;
+                    }
+                    if (technique == TECHNIQUE_COUNT) {
+                        fprintf(stderr, PROGRAM_NAME ": unknown technique '%s'\n", name);
+                        return EXIT_INVALID_ARG;
+                    }
+                    for (tIntSize i = 0; i < options.planLength; i++) {
+                        if (options.plan[i] == (tTechnique)technique) {
+                            fprintf(stderr, PROGRAM_NAME ": technique '%s' appears twice in the plan\n", name);
+                            return EXIT_INVALID_ARG;
+                        }
+                    }
+                    options.plan[options.planLength++] = technique;
+                }
+                break;
+            case 'X':
+                options.adaptivePlan = false;
+                break;
+            case 'C':
+                opt_solve = opt_count = true;
+                if (optarg == NULL) {
+                    options.solutionLimit = SOLUTION_NO_LIMIT;
+                } else if (!parse_count(optarg, 1, &options.solutionLimit)) {
+                    fprintf(stderr, PROGRAM_NAME ": invalid solution count '%s'\n", optarg);
+                    return EXIT_INVALID_ARG;
+                }
+                break;
+            case 'E':
+                opt_solve = opt_all = true;
+                break;
+            case 'L':
+                if (!parse_count(optarg, 1, &opt_limit)) {
+                    fprintf(stderr, PROGRAM_NAME ": invalid limit '%s'\n", optarg);
+                    return EXIT_INVALID_ARG;
+                }
+                break;
+            case 'I':
+                if (!parse_count(optarg, 0, &writer.skipCount)) {
+                    fprintf(stderr, PROGRAM_NAME ": invalid skip count '%s'\n", optarg);
+                    return EXIT_INVALID_ARG;
+                }
+                break;
+            case 'R':
+                if (!parse_count(optarg, 0, &options.seed)) {
+                    fprintf(stderr, PROGRAM_NAME ": invalid seed '%s'\n", optarg);
+                    return EXIT_INVALID_ARG;
+                }
+                break;
+            case 'D':
+                opt_solve = opt_dimacs = true;
+                break;
             case 'h':
                 print_help();
                 return EXIT_SUCCESS;
@@ -74,6 +349,49 @@ int main(int argc, char **argv) {
         }
     }
 
+    if (opt_all && opt_count) {
+        fprintf(stderr, PROGRAM_NAME ": --all and --count cannot be combined\n");
+        return EXIT_INVALID_ARG;
+    }
+    if (opt_dimacs && (opt_all || opt_count)) {
+        fprintf(stderr, PROGRAM_NAME ": --dimacs cannot be combined with --all or --count\n");
+        return EXIT_INVALID_ARG;
+    }
+    if (!opt_all && (opt_limit != SOLUTION_NO_LIMIT || writer.skipCount != 0)) {
+        fprintf(stderr, PROGRAM_NAME ": --limit and --skip require --all\n");
+        return EXIT_INVALID_ARG;
+    }
+
+    // Stream the solutions: the search stops once the skipped and the written ones are found.
+    if (opt_all) {
+        writer.binary = opt_binary;
+        options.onSolution = write_solution;
+        options.solutionContext = &writer;
+        // Backtracking has the cheapest nodes, and there is a solution at nearly every leaf of an under-constrained grid.
+        if (!opt_search) {
+            options.search = SA_backtracking;
+        }
+        options.solutionLimit = opt_limit > SOLUTION_NO_LIMIT - writer.skipCount ? SOLUTION_NO_LIMIT : writer.skipCount + opt_limit;
+    }
+
+    // The encoding is the one the sat engine would solve.
+    if (opt_dimacs) {
+        options.engine = EN_sat;
+        options.dimacsOutput = stdout;
+    }
+
+    // A local search stops at its first solution, and cannot tell that there is no other one.
+    if (options.engine == EN_local && (opt_count || opt_all)) {
+        fprintf(stderr, PROGRAM_NAME ": the local engine cannot be combined with --all or --count\n");
+        return EXIT_INVALID_ARG;
+    }
+
+    // Each solution the sat engine finds is excluded by a clause, for which room is reserved.
+    if (options.engine == EN_sat && options.solutionLimit > SAT_MAX_SOLUTION_LIMIT) {
+        fprintf(stderr, PROGRAM_NAME ": the sat engine finds at most %d solutions: use --count=K or --limit=K\n", SAT_MAX_SOLUTION_LIMIT);
+        return EXIT_INVALID_ARG;
+    }
+
     // parse n argument
 
     if (optind >= argc) {
@@ -87,47 +405,78 @@ int main(int argc, char **argv) {
         return EXIT_INVALID_ARG;
     }
 
+    if (opt_solve && options.engine == EN_dancingLinks && N > DLX_MAX_N) {
+        fprintf(stderr, PROGRAM_NAME ": the dlx engine supports N up to %d\n", DLX_MAX_N);
+        return EXIT_INVALID_ARG;
+    }
+
     gs_grid = grid_create(N);
 
+    // Reserve the temporary memory of the resolution beforehand, so that solving never allocates.
+    if (opt_solve) {
+        arena_reserve(&gs_grid.scratch, resolution_scratchSize(&gs_grid, &options), "solver scratch arena");
+        if (options.engine == EN_dancingLinks) {
+            gs_dlx = dlx_create(N);
+            options.dlx = &gs_dlx;
+        }
+    }
+
     // Load the grid
     if (grid_load(stdin, &gs_grid) == ERROR_INVALID_DATA) {
         fprintf(stderr, PROGRAM_NAME ": the input is not a Sudoku grid of size N=%d.\n", gs_grid.N);
+        grid_free(&gs_grid);
+        dlx_free(&gs_dlx);
         return EXIT_INVALID_DATA;
     }
 
     // Solve the grid
     if (opt_solve) {
-        bool progress; // if progress has been made since the last iteration
-
-        do {
-            progress = perform_simpleTechniques(&gs_grid);
-        } while (progress);
-
-        progress = technique_x_wing(&gs_grid);
-        while (progress) {
-            // Alternate betweeen the X-Wing technique and simple techniques
-            // The X-Wing technique could allow for more progress with simple techniques, and vice versa.
-            // The loop continues until no further progress can be made.
-            progress = technique_x_wing(&gs_grid) || perform_simpleTechniques(&gs_grid);
-        }
-
-        // Collect the positions of the remaining empty cells for backtracking
-        tPosition *emptyCellPositions = check_alloc(array_malloc(emptyCellPositions, grid_size(gs_grid) * grid_size(gs_grid)), "empty cell positions");
+        tSearchStats stats;
 
-        int emptyCellCount = 0;
+        dbg_forbidAllocations(true);
+        bool const isSolved = resolution_getKernel(gs_grid.N)(&gs_grid, &options, &stats);
+        dbg_forbidAllocations(false);
 
-        for (tIntSize r = 0; r < grid_size(gs_grid); r++) {
-            for (tIntSize c = 0; c < grid_size(gs_grid); c++) {
-                if (!cell_hasValue(grid_cellAt(gs_grid, r, c))) {
-                    emptyCellPositions[emptyCellCount++] = (tPosition) { .row = r, .column = c };
-                }
+        if (opt_stats) {
+            for (tIntSize i = 0; i < options.planLength; i++) {
+                tTechniqueStats const *techniqueStats = &stats.techniques[options.plan[i]];
+                fprintf(stderr, "%s: %" PRIu64 " eliminations in %" PRIu64 " us (%" PRIu64 " runs)\n",
+                    gs_techniqueNames[options.plan[i]], techniqueStats->eliminationCount,
+                    techniqueStats->nanoseconds / 1000, techniqueStats->runCount);
             }
+            fprintf(stderr, "nodes: %" PRIu64 "\nbacktracks: %" PRIu64 "\n", stats.nodeCount, stats.backtrackCount);
+        }
+
+        // The encoding has been written instead of solving the grid.
+        if (opt_dimacs) {
+            grid_free(&gs_grid);
+            dlx_free(&gs_dlx);
+            return EXIT_SUCCESS;
         }
 
-        // Wrap up with backtracking which will always solve the grid.
-        technique_backtracking(&gs_grid, emptyCellPositions, emptyCellCount, 0);
+        // The number of solutions is the result, even when it is 0.
+        if (opt_count) {
+            printf("%" PRIu64 "\n", stats.solutionCount);
+            grid_free(&gs_grid);
+            dlx_free(&gs_dlx);
+            return EXIT_SUCCESS;
+        }
 
-        free(emptyCellPositions);
+        // The grid is left in an unspecified state, so it is not printed.
+        // A search that gave up proved nothing, so it is told apart from a grid that has no solution.
+        if (!isSolved) {
+            fprintf(stderr, stats.gaveUp ? PROGRAM_NAME ": the local search gave up.\n" : PROGRAM_NAME ": the grid has no solution.\n");
+            grid_free(&gs_grid);
+            dlx_free(&gs_dlx);
+            return stats.gaveUp ? EXIT_GAVE_UP : EXIT_UNSOLVABLE;
+        }
+
+        // The solutions have been written as they were found.
+        if (opt_all) {
+            grid_free(&gs_grid);
+            dlx_free(&gs_dlx);
+            return EXIT_SUCCESS;
+        }
     }
 
     // Output the grid
@@ -138,6 +487,7 @@ int main(int argc, char **argv) {
     }
 
     grid_free(&gs_grid);
+    dlx_free(&gs_dlx);
 
     return EXIT_SUCCESS;
 }
@@ -19,12 +19,6 @@
 #define STB_DS_IMPLEMENTATION
 #include "stb/ds.h"
 
-#ifdef MEMBDG_VERBOSE
-#define verbose
-#else
-#define verbose __attribute__((unused))
-#endif
-
 typedef enum {
     AM_malloc,
     AM_calloc,
@@ -51,6 +45,8 @@ static AllocationsMapItem *gs_allocations_map;
 
 static bool gs_initialized = false;
 
+static bool gs_allocationsForbidden = false;
+
 static void memdbg_exit(void) {
     // Check that everything has been freed
     bool foundUnfreedAlloc = false;
@@ -90,8 +86,20 @@ void lazyInit(void) {
     gs_initialized = true;
 }
 
-void *dbg_malloc(verbose char const *file, verbose int line, size_t size) {
+static void check_allocationAllowed(char const *file, int line) {
+    if (gs_allocationsForbidden) {
+        fprintf(stderr, "%s:%d: memdbg: heap allocation\n", file, line);
+        dbg_fail("Heap allocation while allocations are forbidden");
+    }
+}
+
+void dbg_forbidAllocations(bool forbid) {
+    gs_allocationsForbidden = forbid;
+}
+
+void *dbg_malloc(char const *file, int line, size_t size) {
     lazyInit();
+    check_allocationAllowed(file, line);
     void *ptr = malloc(size);
 #ifdef MEMDBG_VERBOSE
     fprintf(stderr, "%s:%d: memdbg: malloc(%zu) -> %p\n", file, line, size, ptr);
@@ -106,8 +114,9 @@ void *dbg_malloc(verbose char const *file, verbose int line, size_t size) {
     return ptr;
 }
 
-void *dbg_calloc(verbose char const *file, verbose int line, size_t nmemb, size_t size) {
+void *dbg_calloc(char const *file, int line, size_t nmemb, size_t size) {
     lazyInit();
+    check_allocationAllowed(file, line);
     void *ptr = calloc(nmemb, size);
 #ifdef MEMDBG_VERBOSE
     fprintf(stderr, "%s:%d: memdbg: calloc(%zu, %zu) -> %p\n", file, line, nmemb, size, ptr);
@@ -18,6 +18,7 @@
 #define MEMDBG_H
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -43,6 +44,7 @@
 
 // Disable memory allocation checks.
 #define check_alloc(mallocResult, ...) (mallocResult)
+#define dbg_forbidAllocations(forbid) ((void)0)
 
 #else
 
@@ -62,6 +64,11 @@ void perform_emergencyMemoryCleanup(void);
 /// @return @p mallocResult. Aborts if @p mallocResult is null.
 void *check_alloc(void *mallocResult, char const *fmt_allocComment, ...);
 
+/// @brief Forbids or allows heap allocations.
+/// @param forbid in: whether allocations are forbidden
+/// @remark While allocations are forbidden, any allocation aborts the program. This is used to assert that a section of code does not allocate.
+void dbg_forbidAllocations(bool forbid);
+
 /// @brief Frees memory with debugging.
 /// @param file in: current file
 /// @param line in: current line
@@ -0,0 +1,76 @@
+/** @file
+ * @brief Index queue functions header
+ * @author 5cover, Matteo-K
+ *
+ * A queue holds indexes in range [0 ; capacity[. Pushing an index that is already queued does nothing, so the queue never holds more than @c capacity indexes and its circular buffer never overflows.
+ */
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "arena.h"
+#include "bitset.h"
+#include "types.h"
+
+// Using macros and inline functions to maximize the performance of these simple operations called very frequently in the program.
+
+/// @brief Gets the number of bytes the arrays of a queue occupy in an arena.
+/// @param capacity in: the number of distinct indexes
+#define queue_arenaSize(capacity)                            \
+    (arena_size(sizeof(tIntSize2) * (size_t)(capacity))      \
+        + arena_size(sizeof(tBitsetWord) * bitset_wordCount((size_t)(capacity))))
+
+/// @brief Determines whether a queue is empty.
+#define queue_isEmpty(queue) ((queue)._count == 0)
+
+/// @brief Creates an empty queue, carving its arrays from an arena.
+/// @param arena in/out: the arena. Must have at least @ref queue_arenaSize bytes left.
+/// @param capacity in: the number of distinct indexes
+/// @return An empty queue.
+static inline tQueue queue_create(tArena *arena, tIntSize2 capacity) {
+    tQueue queue = {
+        ._items = arena_alloc(arena, sizeof(tIntSize2) * (size_t)capacity),
+        ._queued = arena_alloc(arena, sizeof(tBitsetWord) * bitset_wordCount((size_t)capacity)),
+        .capacity = capacity,
+        ._head = 0,
+        ._count = 0,
+    };
+    memset(queue._queued, 0, sizeof(tBitsetWord) * bitset_wordCount((size_t)capacity));
+    return queue;
+}
+
+/// @brief Adds an index at the end of a queue, unless it is already queued.
+/// @param queue in/out: the queue
+/// @param index in: the index to add, in range [0 ; capacity[
+static inline void queue_push(tQueue *queue, tIntSize2 index) {
+    assert(index < queue->capacity);
+
+    if (bitset_has(queue->_queued, index)) return;
+
+    bitset_add(queue->_queued, index);
+
+    tIntSize2 tail = queue->_head + queue->_count;
+    queue->_items[tail < queue->capacity ? tail : tail - queue->capacity] = index;
+    queue->_count++;
+}
+
+/// @brief Removes the first index of a non-empty queue.
+/// @param queue in/out: the queue. Must not be empty.
+/// @return The removed index.
+static inline tIntSize2 queue_pop(tQueue *queue) {
+    assert(!queue_isEmpty(*queue));
+
+    tIntSize2 index = queue->_items[queue->_head];
+    bitset_remove(queue->_queued, index);
+
+    if (++queue->_head == queue->capacity) queue->_head = 0;
+    queue->_count--;
+
+    return index;
+}
+
+#endif // QUEUE_H
@@ -6,91 +6,439 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "dlx.h"
 #include "grid.h"
+#include "local.h"
 #include "memdbg.h"
 #include "tCell.h"
 #include "resolution.h"
+#include "sat.h"
+#include "utils.h"
 
-bool perform_simpleTechniques(tGrid *grid) {
+#ifdef KERNEL_N
+
+bool kernel_solveName(KERNEL_N)(tGrid *grid, tSolveOptions const *options, tSearchStats *stats) {
+    assert(grid->N == KERNEL_N);
+    return resolution_solve(grid, options, stats);
+}
+
+#else
+
+tResolutionSolveFunction resolution_getKernel(tIntN N) {
+    switch (N) {
+#define KERNEL_CASE(n) \
+    case n: return kernel_solveName(n);
+        KERNEL_FOREACH_N(KERNEL_CASE)
+#undef KERNEL_CASE
+    default: return resolution_solve;
+    }
+}
+
+size_t resolution_scratchSize(tGrid const *grid, tSolveOptions const *options) {
+    // The techniques run before the search begins. The subsets and fish release their memory after each matrix.
+    return max(resolution_schedulerScratchSize(grid)
+                   + resolution_subsetScratchSize(grid, max(options->subsetMaxSize, options->fishMaxSize)),
+        resolution_searchScratchSize(grid, options));
+}
+
+size_t resolution_schedulerScratchSize(tGrid const *grid) {
+    // Pending units of each technique
+    return TECHNIQUE_COUNT * queue_arenaSize(grid_unitCount(*grid));
+}
+
+size_t resolution_subsetScratchSize(tGrid const *grid, tIntSize maxSize) {
+    if (maxSize < 2) return 0;
+    // Rows + pair buckets + indexes + subset rows + unions
+    return 3 * arena_size(sizeof(tIntSize) * grid_size(*grid))
+         + 2 * arena_size(sizeof(tIntSize) * maxSize)
+         + arena_size(sizeof(tBitsetWord) * (maxSize + 1) * grid_wordCount(*grid));
+}
+
+size_t resolution_searchScratchSize(tGrid const *grid, tSolveOptions const *options) {
+    // Empty cell indexes
+    size_t const emptyCellsSize = arena_size(sizeof(tIntSize2) * grid_cellCount(*grid));
+
+    switch (options->engine) {
+    case EN_search: break;
+    case EN_dancingLinks: return emptyCellsSize + dlx_scratchSize(grid);
+    case EN_sat: return emptyCellsSize + sat_scratchSize(grid, options->solutionLimit);
+    case EN_local: return emptyCellsSize + local_scratchSize(grid);
+    default: abort();
+    }
+
+    switch (options->search) {
+    case SA_backtracking:
+        // Stack of the backtracking
+        return emptyCellsSize
+             + arena_size(sizeof(tIntSize) * grid_cellCount(*grid));
+    case SA_forwardChecking: {
+        // Stack of the forward checking
+        size_t const stackSize = emptyCellsSize
+                               + arena_size(sizeof(tIntSize2) * (grid_cellCount(*grid) + 1))
+                               + arena_size(sizeof(tIntSize) * (grid_cellCount(*grid) + 1));
+        switch (resolution_branchStrategy(*grid, options)) {
+        case BR_snapshot:
+            // + snapshots
+            return stackSize
+                 + arena_size(grid_stateSize(*grid) * (grid_cellCount(*grid) + 1));
+        case BR_trail:
+            // + trail lengths + trail
+            // Along a branch, each cell receives at most one value and loses each of its candidates at most once.
+            return stackSize
+                 + arena_size(sizeof(size_t) * (grid_cellCount(*grid) + 1))
+                 + arena_size(sizeof(tTrailEntry) * grid_cellCount(*grid) * (grid_size(*grid) + 1));
+        default:
+            abort();
+        }
+    }
+    default:
+        abort();
+    }
+}
+
+#endif // KERNEL_N
+
+bool resolution_solve(tGrid *grid, tSolveOptions const *options, tSearchStats *stats) {
+    *stats = (tSearchStats) { 0 };
+
+    // The encoding of a grid is written even if it has no solution.
+    bool const writesDimacs = options->engine == EN_sat && options->dimacsOutput != NULL;
+
+    // The givens contradict each other.
+    if (grid->hasContradiction && !writesDimacs) return false;
+
+    // Every empty cell and every unit must be examined once.
+    for (tIntSize2 iCell = 0; iCell < grid_cellCount(*grid); iCell++) {
+        if (grid_value(*grid, iCell) == 0) {
+            queue_push(&grid->_dirtyCells, iCell);
+        }
+    }
+    for (tIntSize2 unit = 0; unit < grid_unitCount(*grid); unit++) {
+        queue_push(&grid->_dirtyUnits, unit);
+    }
+
+    size_t const scratchMark = arena_mark(&grid->scratch);
+
+    tScheduler scheduler;
+    for (tIntSize i = 0; i < TECHNIQUE_COUNT; i++) {
+        scheduler.pending[i] = queue_create(&grid->scratch, grid_unitCount(*grid));
+        scheduler.stats[i] = (tTechniqueStats) { 0 };
+    }
+
+    resolution_propagate(grid, options, &scheduler);
+
+    memcpy(stats->techniques, scheduler.stats, sizeof scheduler.stats);
+
+    // The pending units are not needed anymore.
+    arena_release(&grid->scratch, scratchMark);
+
+    // The techniques found a contradiction: searching would explore the whole tree in vain.
+    if (grid->hasContradiction && !writesDimacs) return false;
+
+    // Collect the indexes of the remaining empty cells for backtracking
+    tIntSize2 *emptyCells = arena_array_alloc(&grid->scratch, emptyCells, grid_cellCount(*grid));
+
+    tIntSize2 emptyCellCount = 0;
+
+    for (tIntSize2 iCell = 0; iCell < grid_cellCount(*grid); iCell++) {
+        if (grid_value(*grid, iCell) == 0) {
+            emptyCells[emptyCellCount++] = iCell;
+        }
+    }
+
+    // Wrap up with a search, which solves the grid unless it has no solution.
+    // The techniques only removed candidates that are in no solution, so the search finds all of them.
+    // It resumes after each solution until enough are found.
+    uint64_t solutionCount = 0;
+    tSearchStats searchStats;
+
+    switch (options->engine) {
+    case EN_search:
+        switch (options->search) {
+        case SA_backtracking: {
+            tBacktracking search;
+            technique_backtracking_start(grid, &search, emptyCells, emptyCellCount);
+            while (technique_backtracking_run(grid, &search, BACKTRACKING_NO_LIMIT) == BS_solved
+                   && resolution_recordSolution(grid, options, &solutionCount)
+                   && technique_backtracking_next(&search)) {
+            }
+            searchStats = search.stats;
+            break;
+        }
+        case SA_forwardChecking: {
+            tForwardChecking search;
+            technique_forwardChecking_start(grid, &search, emptyCells, emptyCellCount, resolution_branchStrategy(*grid, options));
+            while (technique_forwardChecking_run(grid, &search, BACKTRACKING_NO_LIMIT) == BS_solved
+                   && resolution_recordSolution(grid, options, &solutionCount)
+                   && technique_forwardChecking_next(&search)) {
+            }
+            searchStats = search.stats;
+            break;
+        }
+        default:
+            abort();
+        }
+        break;
+    case EN_dancingLinks:
+        dlx_start(options->dlx, grid);
+        while (dlx_run(options->dlx, grid, BACKTRACKING_NO_LIMIT) == BS_solved
+               && resolution_recordSolution(grid, options, &solutionCount)
+               && dlx_next(options->dlx)) {
+        }
+        searchStats = options->dlx->stats;
+        // Give the matrix back its rows and columns, for the next grid.
+        dlx_stop(options->dlx);
+        break;
+    case EN_sat: {
+        tSat sat;
+        sat_start(&sat, grid, options->solutionLimit);
+        if (writesDimacs) {
+            sat_writeDimacs(&sat, grid, options->dimacsOutput);
+        } else {
+            while (sat_run(&sat, grid, BACKTRACKING_NO_LIMIT) == BS_solved
+                   && resolution_recordSolution(grid, options, &solutionCount)
+                   && sat_next(&sat)) {
+            }
+        }
+        searchStats = sat.stats;
+        break;
+    }
+    case EN_local: {
+        // A local search only ever finds one solution.
+        tLocalSearch search;
+        local_start(&search, grid, options->seed);
+        switch (local_run(&search, grid, BACKTRACKING_NO_LIMIT)) {
+        case BS_solved: resolution_recordSolution(grid, options, &solutionCount); break;
+        case BS_paused: stats->gaveUp = true; break;
+        default: break;
+        }
+        searchStats = search.stats;
+        break;
+    }
+    default:
+        abort();
+    }
+
+    stats->nodeCount = searchStats.nodeCount;
+    stats->backtrackCount = searchStats.backtrackCount;
+    stats->solutionCount = solutionCount;
+
+    arena_release(&grid->scratch, scratchMark);
+
+    return solutionCount > 0;
+}
+
+bool resolution_recordSolution(tGrid const *grid, tSolveOptions const *options, uint64_t *solutionCount) {
+    if (options->onSolution != NULL) {
+        options->onSolution(grid, options->solutionContext);
+    }
+    return ++*solutionCount < options->solutionLimit;
+}
+
+bool resolution_propagate(tGrid *grid, tSolveOptions const *options, tScheduler *scheduler) {
     bool progress = false;
-    tCell *cell;
 
-    for (tIntSize r = 0; r < grid_size(*grid); r++) {
-        for (tIntSize c = 0; c < grid_size(*grid); c++) {
-            // Executing the techniques in order of increasing complexity.
+    // The techniques only run where something changed. Each change they make queues more work, until the grid is stable.
+    for (;;) {
+        // A contradiction makes every further deduction meaningless.
+        if (grid->hasContradiction) {
+            return progress;
+        }
+
+        // Placed values are propagated first, so that the other techniques never see a candidate that conflicts with a value.
+        if (!queue_isEmpty(grid->_placedCells)) {
+            tIntSize2 iCell = queue_pop(&grid->_placedCells);
+            progress |= grid_removeCandidateFromPeers(grid, iCell, grid_value(*grid, iCell));
+        } else if (!queue_isEmpty(grid->_dirtyCells)) {
             // As soon as the value of the cell is defined, we move on to the next one.
+            tIntSize2 iCell = queue_pop(&grid->_dirtyCells);
+
+            if (grid_value(*grid, iCell) != 0) continue;
+
+            progress |= technique_nakedSingleton(grid, iCell);
+        } else if (!queue_isEmpty(grid->_dirtyUnits)) {
+            tIntSize2 unit = queue_pop(&grid->_dirtyUnits);
+
+            progress |= technique_hiddenSingleton(grid, unit);
+
+            // The techniques of the plan will run on the unit once the singletons stall.
+            for (tIntSize i = 0; i < options->planLength; i++) {
+                queue_push(&scheduler->pending[options->plan[i]], unit);
+            }
+        } else if (resolution_escalate(grid, options, scheduler)) {
+            progress = true;
+        } else {
+            return progress;
+        }
+    }
+}
 
-            // Save time by avoiding to recalculate the address of the cell each time.
-            cell = &grid_cellAt(*grid, r, c);
+bool resolution_escalate(tGrid *grid, tSolveOptions const *options, tScheduler *scheduler) {
+    for (;;) {
+        // Choose the technique with pending units that comes first in the plan, or that has the best yield.
+        int technique = -1;
+        for (tIntSize i = 0; i < options->planLength; i++) {
+            tTechnique const candidate = options->plan[i];
+            if (queue_isEmpty(scheduler->pending[candidate])) continue;
+            if (technique == -1) {
+                technique = candidate;
+                if (!options->adaptivePlan) break;
+            } else if (technique_yield(scheduler->stats[candidate]) > technique_yield(scheduler->stats[technique])) {
+                technique = candidate;
+            }
+        }
 
-            if (cell_hasValue(*cell)) continue;
+        // No technique has pending units: the grid is stable.
+        if (technique == -1) return false;
+
+        if (resolution_runTechnique(grid, options, scheduler, technique)) return true;
+    }
+}
 
-            progress |= technique_nakedSingleton(grid, r, c);
-            if (cell_hasValue(*cell)) continue;
+bool resolution_runTechnique(tGrid *grid, tSolveOptions const *options, tScheduler *scheduler, tTechnique technique) {
+    tQueue *pending = &scheduler->pending[technique];
+    tTechniqueStats *stats = &scheduler->stats[technique];
 
-            progress |= technique_hiddenSingleton(grid, r, c);
-            if (cell_hasValue(*cell)) continue;
+    uint64_t const eliminationCount = grid->eliminationCount;
+    uint64_t const start = resolution_nanoseconds();
 
-            progress |= technique_nakedPair(grid, r, c);
-            if (cell_hasValue(*cell)) continue;
+    bool progress = false;
 
-            progress |= technique_hiddenPair(grid, r, c);
+    if (technique == TE_fish) {
+        // The fish technique covers the whole grid, so it runs once for all the pending units.
+        while (!queue_isEmpty(*pending)) {
+            queue_pop(pending);
+        }
+        progress = technique_fish(grid, options->fishMaxSize);
+        stats->runCount++;
+    } else {
+        // Go back to the singletons as soon as the technique makes progress.
+        while (!progress && !queue_isEmpty(*pending)) {
+            tIntSize2 unit = queue_pop(pending);
+            switch (technique) {
+            case TE_lockedCandidates: progress = technique_lockedCandidates(grid, unit); break;
+            case TE_nakedSubset: progress = technique_nakedSubset(grid, unit, options->subsetMaxSize); break;
+            case TE_hiddenSubset: progress = technique_hiddenSubset(grid, unit, options->subsetMaxSize); break;
+            default: abort();
+            }
+            stats->runCount++;
         }
     }
 
+    stats->nanoseconds += resolution_nanoseconds() - start;
+    stats->eliminationCount += grid->eliminationCount - eliminationCount;
+
     return progress;
 }
 
-bool technique_backtracking(tGrid *grid, tPosition *emptyCellPositions, tIntSize emptyCellCount, tIntSize iCellPosition) {
-    // This technique does not use candidates but value presence arrays.
-    // The reason is that synchronizing the candidates between recursive calls requires loops.
-    // While for the value arrays it is a simple boolean that indicates whether a value is present in a group (row, block or column).
-
-    // we have processed all the cells, the grid is solved
-    if (iCellPosition == emptyCellCount) {
-        return true;
+void technique_backtracking_start(tGrid *grid, tBacktracking *search, tIntSize2 *emptyCells, tIntSize2 emptyCellCount) {
+    search->emptyCells = emptyCells;
+    search->emptyCellCount = emptyCellCount;
+    search->_values = arena_array_alloc(&grid->scratch, search->_values, emptyCellCount);
+    search->_depth = 0;
+    search->stats = (tSearchStats) { 0 };
+
+    // Select the first cell to solve
+    if (emptyCellCount > 0) {
+        search->_values[0] = 0;
+        technique_backtracking_swap_cells(grid, emptyCells, emptyCellCount, 0);
     }
+}
 
-    assert(iCellPosition < emptyCellCount);
+tBacktrackingStatus technique_backtracking_run(tGrid *grid, tBacktracking *search, uint64_t nodeBudget) {
+    // This technique does not use candidates but value presence bitsets.
+    // The reason is that synchronizing the candidates between assumptions requires loops.
+    // While for the value bitsets it is a single bit that indicates whether a value is present in a unit (row, block or column).
 
-    // Select the cell to solve
-    technique_backtracking_swap_cells(grid, emptyCellPositions, emptyCellCount, iCellPosition);
+    // The frames of the depths above the current one hold the values assumed so far.
+    // The frame of the current depth holds the last value tried for its cell, or 0 if none was tried yet.
+    tIntSize2 depth = search->_depth;
 
-    tPosition pos = emptyCellPositions[iCellPosition];
+    while (depth < search->emptyCellCount) {
+        if (nodeBudget == 0) {
+            search->_depth = depth;
+            return BS_paused;
+        }
 
-    for (tIntSize value = 1; value <= grid_size(*grid); value++) {
-        if (grid_possible(*grid, pos.row, pos.column, value)) {
-            // assuming that the cell contains this value,
-            grid_markValueFree(false, *grid, pos.row, pos.column, value);
+        tIntSize2 const iCell = search->emptyCells[depth];
+        tIntSize const lastValue = search->_values[depth];
 
-            // move on to the next cell: recursive call to see if the value is good afterwards
-            if (technique_backtracking(grid, emptyCellPositions, emptyCellCount, iCellPosition + 1)) {
-                // the value is good, put it and return.
-                grid_cellAtPos(*grid, pos)._value = value;
-                return true;
+        // Solving the following cells assuming this value has failed, so we don't have the right value.
+        if (lastValue != 0) {
+            grid_markValueFree(true, *grid, iCell, lastValue);
+        }
+
+        // Find the next possible value of the cell, in increasing order.
+        tIntSize value = 0;
+        for (tIntSize w = lastValue / BITSET_WORD_BITS; w < grid_wordCount(*grid) && value == 0; w++) {
+            tBitsetWord possibleValues = grid_cellPossibleValues(*grid, iCell, w);
+            // skip the values already tried
+            if (w == lastValue / BITSET_WORD_BITS) {
+                possibleValues &= ~(tBitsetWord)0 << (lastValue % BITSET_WORD_BITS);
             }
+            if (possibleValues != 0) {
+                value = w * BITSET_WORD_BITS + word_ctz(possibleValues) + 1;
+            }
+        }
+
+        if (value == 0) {
+            // We failed for all values: go back to the previous cell and try its next value.
+            search->_values[depth] = 0;
+            search->stats.backtrackCount++;
+            if (depth == 0) {
+                search->_depth = 0;
+                return BS_exhausted;
+            }
+            depth--;
+            continue;
+        }
+
+        // assuming that the cell contains this value,
+        grid_markValueFree(false, *grid, iCell, value);
+        search->_values[depth] = value;
+        search->stats.nodeCount++;
+        nodeBudget -= nodeBudget != BACKTRACKING_NO_LIMIT;
 
-            // Solving the following cells assuming this value has failed, so we don't have the right value.
-            grid_markValueFree(true, *grid, pos.row, pos.column, value);
+        // move on to the next cell
+        if (++depth < search->emptyCellCount) {
+            search->_values[depth] = 0;
+            technique_backtracking_swap_cells(grid, search->emptyCells, search->emptyCellCount, depth);
         }
     }
 
-    // We failed for all values
-    return false;
+    // we have processed all the cells, the grid is solved: put the values.
+    for (tIntSize2 d = 0; d < search->emptyCellCount; d++) {
+        grid_value(*grid, search->emptyCells[d]) = search->_values[d];
+    }
+
+    search->_depth = depth;
+    return BS_solved;
 }
 
-void technique_backtracking_swap_cells(tGrid const *grid, tPosition *emptyCellPositions, tIntSize emptyCellCount, tIntSize iHere) {
+bool technique_backtracking_next(tBacktracking *search) {
+    assert(search->_depth == search->emptyCellCount);
+
+    // The grid had no empty cell: its only solution is itself.
+    if (search->emptyCellCount == 0) return false;
+
+    // Go back to the last cell: the next run tries its next value.
+    search->_depth = search->emptyCellCount - 1;
+    return true;
+}
+
+void technique_backtracking_swap_cells(tGrid const *grid, tIntSize2 *emptyCells, tIntSize2 emptyCellCount, tIntSize2 iHere) {
     assert(iHere < emptyCellCount);
 
-    tPosition pos = emptyCellPositions[iHere];
-    tIntSize iMin = iHere;
-    grid_cellPossibleValuesCount(*grid, pos.row, pos.column, possibleValCountMin);
+    tIntSize2 iMin = iHere;
+    grid_cellPossibleValuesCount(*grid, emptyCells[iHere], possibleValCountMin);
 
     // find the cell after which has the least possible values
-    for (tIntSize i = iHere + 1; i < emptyCellCount; i++) {
-        pos = emptyCellPositions[i];
-        grid_cellPossibleValuesCount(*grid, pos.row, pos.column, possibleValCountI);
+    // A cell with no possible value is a dead end, and the first one is the cell a full scan would select.
+    // Searching further would cost a scan of the remaining cells for no benefit, so we stop there.
+    for (tIntSize2 i = iHere + 1; i < emptyCellCount && possibleValCountMin > 0; i++) {
+        grid_cellPossibleValuesCount(*grid, emptyCells[i], possibleValCountI);
 
         if (possibleValCountI < possibleValCountMin) {
             iMin = i;
@@ -99,356 +447,475 @@ void technique_backtracking_swap_cells(tGrid const *grid, tPosition *emptyCellPo
     }
 
     // swap the cells
-    tPosition tmp = emptyCellPositions[iHere];
-    emptyCellPositions[iHere] = emptyCellPositions[iMin];
-    emptyCellPositions[iMin] = tmp;
+    tIntSize2 tmp = emptyCells[iHere];
+    emptyCells[iHere] = emptyCells[iMin];
+    emptyCells[iMin] = tmp;
 }
 
-bool technique_nakedSingleton(tGrid *grid, tIntSize row, tIntSize column) {
-    bool progress = false;
+void technique_forwardChecking_start(tGrid *grid, tForwardChecking *search, tIntSize2 *emptyCells, tIntSize2 emptyCellCount, tBranchStrategy branch) {
+    assert(branch == BR_snapshot || branch == BR_trail);
+
+    search->emptyCells = emptyCells;
+    search->emptyCellCount = emptyCellCount;
+    search->_branch = branch;
+    // There is one more frame than assumed values: the one of the cell selected last.
+    search->_cells = arena_array_alloc(&grid->scratch, search->_cells, emptyCellCount + 1);
+    search->_values = arena_array_alloc(&grid->scratch, search->_values, emptyCellCount + 1);
+    if (branch == BR_snapshot) {
+        search->_trailLengths = NULL;
+        search->_trail = NULL;
+        search->_snapshots = arena_alloc(&grid->scratch, grid_stateSize(*grid) * (emptyCellCount + 1));
+    } else {
+        search->_trailLengths = arena_array_alloc(&grid->scratch, search->_trailLengths, emptyCellCount + 1);
+        search->_trail = arena_array_alloc(&grid->scratch, search->_trail, (size_t)emptyCellCount * (grid_size(*grid) + 1));
+        search->_snapshots = NULL;
+    }
+    search->_trailLength = 0;
+    search->_depth = 0;
+    search->stats = (tSearchStats) { 0 };
+
+    // Select the first cell to solve
+    search->_cells[0] = technique_forwardChecking_selectCell(grid, search);
+    search->_values[0] = 0;
+}
+
+tBacktrackingStatus technique_forwardChecking_run(tGrid *grid, tForwardChecking *search, uint64_t nodeBudget) {
+    // The frames of the depths above the current one hold the values assumed so far.
+    // The frame of the current depth holds the last value tried for its cell, or 0 if none was tried yet.
+    tIntSize2 depth = search->_depth;
+
+    for (;;) {
+        tIntSize2 const iCell = search->_cells[depth];
 
-    tCell *cell = &grid_cellAt(*grid, row, column);
-    if (cell_candidate_count(*cell) == 1) {
-        cell_get_first_candidate(*cell, candidate);
-        // remove all corresponding candidates
-        // there will be at least one removal, the unique candidate of the cell.
-        progress |= grid_removeCandidateFromRow(grid, row, candidate);
-        progress |= grid_removeCandidateFromColumn(grid, column, candidate);
-        progress |= grid_removeCandidateFromBlock(grid, row, column, candidate);
+        // All the cells have a value: the grid is solved.
+        if (iCell == grid_cellCount(*grid)) {
+            search->_depth = depth;
+            return BS_solved;
+        }
+
+        if (nodeBudget == 0) {
+            search->_depth = depth;
+            return BS_paused;
+        }
+
+        tIntSize const lastValue = search->_values[depth];
+
+        // Assuming the last value has failed: go back to the state of the grid before it was assumed.
+        // This gives its candidates back to the cell.
+        if (lastValue != 0) {
+            technique_forwardChecking_restore(grid, search, depth);
+        }
+
+        // Find the next candidate of the cell, in increasing order.
+        int const bit = bitset_next(grid_candidates(*grid, iCell), grid_wordCount(*grid), lastValue);
+
+        if (bit == -1) {
+            // We failed for all values: go back to the previous cell and try its next value.
+            search->_values[depth] = 0;
+            search->stats.backtrackCount++;
+            if (depth == 0) {
+                search->_depth = 0;
+                return BS_exhausted;
+            }
+            depth--;
+            continue;
+        }
+
+        // assuming that the cell contains this value,
+        tIntSize const value = bit + 1;
+        if (lastValue == 0) {
+            technique_forwardChecking_save(grid, search, depth);
+        }
+        search->_values[depth] = value;
+        search->stats.nodeCount++;
+        nodeBudget -= nodeBudget != BACKTRACKING_NO_LIMIT;
+
+        // If this leads to a contradiction, try the next value.
+        if (!technique_forwardChecking_assign(grid, search, iCell, value)
+            || !technique_forwardChecking_propagate(grid, search)) {
+            continue;
+        }
+
+        // move on to the next cell
+        search->_cells[++depth] = technique_forwardChecking_selectCell(grid, search);
+        search->_values[depth] = 0;
     }
+}
 
-    return progress;
+bool technique_forwardChecking_next(tForwardChecking *search) {
+    // No value was assumed: the solution was forced.
+    if (search->_depth == 0) return false;
+
+    // Go back to the last assumed value: the next run undoes it and tries the next one.
+    search->_depth--;
+    return true;
 }
 
-bool technique_hiddenSingleton(tGrid *grid, tIntSize row, tIntSize column) {
-    tPosition candidatePos;
-    int candidate;
-    bool progress = false;
+tIntSize2 technique_forwardChecking_selectCell(tGrid const *grid, tForwardChecking const *search) {
+    tIntSize2 iMin = grid_cellCount(*grid);
+    tIntSize candidateCountMin = grid_size(*grid) + 1;
+
+    // find the empty cell which has the least candidates
+    // The singles have been assigned, so a cell with 2 candidates is one of the best.
+    for (tIntSize2 i = 0; i < search->emptyCellCount && candidateCountMin > 2; i++) {
+        tIntSize2 const iCell = search->emptyCells[i];
+        if (grid_value(*grid, iCell) == 0 && grid_candidateCount(*grid, iCell) < candidateCountMin) {
+            iMin = iCell;
+            candidateCountMin = grid_candidateCount(*grid, iCell);
+        }
+    }
 
-    int const blockRow = grid_blockIndex(*grid, row);
-    int const blockCol = grid_blockIndex(*grid, column);
-
-    // Block
-    if ((candidate = technique_hiddenSingleton_findUniqueCandidate(
-             grid,
-             blockRow, blockRow + grid->N,
-             blockCol, blockCol + grid->N,
-             &candidatePos))
-        != 0) {
-        grid_cell_provideValue(grid, candidatePos.row, candidatePos.column, candidate);
-        grid_removeCandidateFromRow(grid, candidatePos.row, candidate);
-        grid_removeCandidateFromColumn(grid, candidatePos.column, candidate);
-        progress = true;
+    return iMin;
+}
+
+/// @brief Records a change of the grid on the trail of a forward checking search, if it branches with a trail.
+#define forwardChecking_record(search, iChangedCell, removedCandidate)                                                           \
+    do {                                                                                                                         \
+        if ((search)->_branch == BR_trail) {                                                                                     \
+            (search)->_trail[(search)->_trailLength++] = (tTrailEntry) { .iCell = (iChangedCell), .candidate = (removedCandidate) }; \
+        }                                                                                                                        \
+    } while (0)
+
+bool technique_forwardChecking_assign(tGrid *grid, tForwardChecking *search, tIntSize2 iCell, tIntSize value) {
+    // The cell may already have a value whose candidates have not been removed yet.
+    if (grid_value(*grid, iCell) != 0) {
+        return grid_value(*grid, iCell) == value;
     }
-    // Row
-    if ((candidate = technique_hiddenSingleton_findUniqueCandidate(
-             grid,
-             row, row + 1,
-             0, grid_size(*grid),
-             &candidatePos))
-        != 0) {
-        grid_cell_provideValue(grid, candidatePos.row, candidatePos.column, candidate);
-        grid_removeCandidateFromBlock(grid, candidatePos.row, candidatePos.column, candidate);
-        grid_removeCandidateFromColumn(grid, candidatePos.column, candidate);
-        progress = true;
+    // The value may have been placed in a unit of the cell without being removed from its candidates yet.
+    if (!grid_possible(*grid, iCell, value)) {
+        return false;
     }
-    // chaud: the two ones above fail
-    // chaud: this one succeeds
-
-    // Column
-    if ((candidate = technique_hiddenSingleton_findUniqueCandidate(
-             grid,
-             0, grid_size(*grid),
-             column, column + 1,
-             &candidatePos))
-        != 0) {
-        grid_cell_provideValue(grid, candidatePos.row, candidatePos.column, candidate);
-        grid_removeCandidateFromBlock(grid, candidatePos.row, candidatePos.column, candidate);
-        grid_removeCandidateFromRow(grid, candidatePos.row, candidate);
-        progress = true;
+
+    grid_value(*grid, iCell) = value;
+    grid_markValueFree(false, *grid, iCell, value);
+    forwardChecking_record(search, iCell, 0);
+    queue_push(&grid->_placedCells, iCell);
+
+    return true;
+}
+
+bool technique_forwardChecking_removeCandidate(tGrid *grid, tForwardChecking *search, tIntSize2 iCell, tIntSize candidate) {
+    tBitsetWord *candidates = grid_candidates(*grid, iCell);
+
+    if (!bitset_has(candidates, candidate - 1)) return true;
+
+    bitset_remove(candidates, candidate - 1);
+    grid_forgetCandidatePosition(*grid, iCell, candidate);
+    grid_candidateCount(*grid, iCell)--;
+    forwardChecking_record(search, iCell, candidate);
+
+    // naked single: the cell has no other place for a value
+    if (grid_value(*grid, iCell) == 0) {
+        switch (grid_candidateCount(*grid, iCell)) {
+        case 0: return false;
+        case 1:
+            if (!technique_forwardChecking_assign(grid, search, iCell, bitset_first(candidates) + 1)) return false;
+            break;
+        }
     }
 
-    return progress;
+    // hidden single: the candidate has one place left in a unit of the cell
+    for (tIntSize kind = 0; kind < UNIT_KIND_COUNT; kind++) {
+        tIntSize2 const unit = grid_unitOf(*grid, iCell, kind);
+
+        // The candidate already has its place in the unit.
+        if (bitset_has(grid_unitValues(*grid, unit), candidate - 1)) continue;
+
+        tBitsetWord const *positions = grid_unitPositions(*grid, unit, candidate);
+        switch (bitset_count(positions, grid_wordCount(*grid))) {
+        case 0: return false;
+        case 1:
+            if (!technique_forwardChecking_assign(grid, search, grid_unitCellAt(*grid, unit, bitset_first(positions)), candidate)) return false;
+            break;
+        }
+    }
+
+    return true;
 }
 
-int technique_hiddenSingleton_findUniqueCandidate(
-    tGrid const *grid,
-    tIntSize rStart, tIntSize rEnd,
-    tIntSize cStart, tIntSize cEnd,
-    tPosition *candidatePosition) {
-    tIntSize *candidateCounts = check_alloc(array_calloc(candidateCounts, grid_size(*grid) + 1), "candidate counts array");
+bool technique_forwardChecking_propagate(tGrid *grid, tForwardChecking *search) {
+    bool consistent = true;
 
-    for (tIntSize r = rStart; r < rEnd; r++) {
-        for (tIntSize c = cStart; c < cEnd; c++) {
-            tCell cell = grid_cellAt(*grid, r, c);
-            for (tIntSize candidate = 1; candidate <= grid_size(*grid); candidate++) {
-                candidateCounts[candidate] += cell_hasCandidate(cell, candidate);
-            }
+    while (consistent && !queue_isEmpty(grid->_placedCells)) {
+        tIntSize2 const iCell = queue_pop(&grid->_placedCells);
+        tIntSize const value = grid_value(*grid, iCell);
+
+        // The cell has a value, so it has no candidates left.
+        bitset_forEach(grid_candidates(*grid, iCell), grid_wordCount(*grid), bit) {
+            if (!(consistent = technique_forwardChecking_removeCandidate(grid, search, iCell, bit + 1))) break;
+        }
+
+        for (tIntSize iPeer = 0; consistent && iPeer < grid_peerCount(*grid); iPeer++) {
+            consistent = technique_forwardChecking_removeCandidate(grid, search, grid_peerAt(*grid, iCell, iPeer), value);
         }
     }
 
-    // Search for the unique candidate
-    tIntSize candidate = 1;
-    while (candidate <= grid_size(*grid) && candidateCounts[candidate] != 1) {
-        candidate++;
+    // Forget the cells left to propagate after a contradiction. Their changes will be undone.
+    while (!queue_isEmpty(grid->_placedCells)) {
+        queue_pop(&grid->_placedCells);
     }
 
-    free(candidateCounts);
+    return consistent;
+}
 
-    // If it hasn't been found
-    if (candidate == grid_size(*grid) + 1) {
-        return 0;
+/// @brief Gets the snapshot of the state of the grid of a depth.
+#define forwardChecking_snapshot(grid, search, depth) (&(search)->_snapshots[grid_stateSize(grid) * (depth)])
+
+void technique_forwardChecking_save(tGrid const *grid, tForwardChecking *search, tIntSize2 depth) {
+    if (search->_branch == BR_snapshot) {
+        memcpy(forwardChecking_snapshot(*grid, search, depth), grid->_values, grid_stateSize(*grid));
+    } else {
+        search->_trailLengths[depth] = search->_trailLength;
     }
+}
 
-    for (tIntSize r = rStart; r < rEnd; r++) {
-        for (tIntSize c = cStart; c < cEnd; c++) {
-            if (cell_hasCandidate(grid_cellAt(*grid, r, c), candidate)) {
-                *candidatePosition = (tPosition) { .row = r, .column = c };
-                return candidate;
-            }
+void technique_forwardChecking_restore(tGrid *grid, tForwardChecking *search, tIntSize2 depth) {
+    if (search->_branch == BR_snapshot) {
+        memcpy(grid->_values, forwardChecking_snapshot(*grid, search, depth), grid_stateSize(*grid));
+    } else {
+        technique_forwardChecking_undo(grid, search, search->_trailLengths[depth]);
+    }
+}
+
+void technique_forwardChecking_undo(tGrid *grid, tForwardChecking *search, size_t trailLength) {
+    // Undo the changes in reverse order.
+    while (search->_trailLength > trailLength) {
+        tTrailEntry const change = search->_trail[--search->_trailLength];
+
+        if (change.candidate == 0) {
+            grid_markValueFree(true, *grid, change.iCell, grid_value(*grid, change.iCell));
+            grid_value(*grid, change.iCell) = 0;
+        } else {
+            bitset_add(grid_candidates(*grid, change.iCell), change.candidate - 1);
+            grid_rememberCandidatePosition(*grid, change.iCell, change.candidate);
+            grid_candidateCount(*grid, change.iCell)++;
         }
     }
+}
 
-    dbg_fail("Unreachable code bug : unique candidate not found even though it was found earlier");
+bool technique_nakedSingleton(tGrid *grid, tIntSize2 iCell) {
+    if (grid_candidateCount(*grid, iCell) != 1) return false;
+
+    // The candidate is removed from the peers when the placed cell is propagated.
+    grid_cell_provideValue(grid, iCell, bitset_first(grid_candidates(*grid, iCell)) + 1);
+    return true;
 }
 
-bool technique_nakedPair(tGrid *grid, tIntSize row, tIntSize column) {
+bool technique_hiddenSingleton(tGrid *grid, tIntSize2 unit) {
     bool progress = false;
 
-    tCell *cellRowColumn = &grid_cellAt(*grid, row, column);
+    tIntSize2 iCandidateCell;
+    int candidate;
+    while ((candidate = technique_hiddenSingleton_findUniqueCandidate(grid, unit, &iCandidateCell)) > 0) {
+        // The other cells of the unit don't have the candidate, so this only affects the 2 other units of the cell.
+        // The candidate is removed from them when the placed cell is propagated.
+        grid_cell_provideValue(grid, iCandidateCell, candidate);
+        progress = true;
+    }
 
-    if (cell_candidate_count(*cellRowColumn) == 2) {
-        tIntSize const blockRow = grid_blockIndex(*grid, row);
-        tIntSize const blockCol = grid_blockIndex(*grid, column);
+    if (candidate == -1) {
+        grid->hasContradiction = true;
+    }
 
-        tPair2 pair = (tPair2) {
-            .candidates = {
-                cell_candidateAt(cellRowColumn, 1),
-                cell_candidateAt(cellRowColumn, 2) },
-            .count = 1,
-        };
+    return progress;
+}
 
-        for (tIntSize r = blockRow; r < blockRow + grid->N && pair.count < 2; r++) {
-            for (tIntSize c = blockCol; c < blockCol + grid->N && pair.count < 2; c++) {
-                pair.count += (r != row || c != column) && technique_nakedPair_isPairCell(grid_cellAt(*grid, r, c), pair);
-            }
+int technique_hiddenSingleton_findUniqueCandidate(tGrid const *grid, tIntSize2 unit, tIntSize2 *iCandidateCell) {
+    // A candidate is unique in the unit if it has exactly one position.
+    for (tIntSize candidate = 1; candidate <= grid_size(*grid); candidate++) {
+        tBitsetWord const *positions = grid_unitPositions(*grid, unit, candidate);
+        switch (bitset_count(positions, grid_wordCount(*grid))) {
+        case 0:
+            // A value must be in the unit or have a position in it.
+            if (!bitset_has(grid_unitValues(*grid, unit), candidate - 1)) return -1;
+            break;
+        case 1:
+            *iCandidateCell = grid_unitCellAt(*grid, unit, bitset_first(positions));
+            return candidate;
         }
+    }
 
-        if (pair.count == 2) {
-            // Remove all candidates from the block except on the cells containing only the candidates of the pair
-            // So we cannot use grid_removeCandidateFromBlock
-            for (tIntSize r = blockRow; r < blockRow + grid->N; r++) {
-                for (tIntSize c = blockCol; c < blockCol + grid->N; c++) {
-                    bool isNotPairCell = !technique_nakedPair_isPairCell(grid_cellAt(*grid, r, c), pair);
-                    progress |= isNotPairCell && grid_cell_removeCandidate(grid, r, c, pair.candidates[0]);
-                    progress |= isNotPairCell && grid_cell_removeCandidate(grid, r, c, pair.candidates[1]);
-                }
-            }
+    return 0;
+}
+
+bool technique_lockedCandidates(tGrid *grid, tIntSize2 unit) {
+    bool progress = false;
+    bool const isBlock = grid_unitKind(*grid, unit) == UK_block;
+
+    for (tIntSize candidate = 1; candidate <= grid_size(*grid); candidate++) {
+        tBitsetWord const *positions = grid_unitPositions(*grid, unit, candidate);
+
+        // A candidate with less than 2 positions is placed or is a hidden singleton.
+        int const first = bitset_next(positions, grid_wordCount(*grid), 0);
+        if (first == -1 || bitset_next(positions, grid_wordCount(*grid), first + 1) == -1) continue;
+
+        // The positions in the same row of a block, or in the same block of a line, have the same quotient by N.
+        // The positions in the same column of a block have the same remainder.
+        bool sameQuotient = true, sameRemainder = isBlock;
+        bitset_forEachFrom(positions, grid_wordCount(*grid), first + 1, position) {
+            sameQuotient &= position / grid_N(*grid) == first / grid_N(*grid);
+            sameRemainder &= position % grid_N(*grid) == first % grid_N(*grid);
+        }
+
+        tIntSize2 const firstCell = grid_unitCellAt(*grid, unit, first);
+        if (sameQuotient) {
+            progress |= technique_lockedCandidates_eliminate(grid, unit, candidate,
+                grid_unitOf(*grid, firstCell, isBlock ? UK_row : UK_block));
+        } else if (sameRemainder) {
+            progress |= technique_lockedCandidates_eliminate(grid, unit, candidate,
+                grid_unitOf(*grid, firstCell, UK_column));
         }
     }
 
     return progress;
 }
 
-bool technique_hiddenPair(tGrid *grid, tIntSize row, tIntSize column) {
-    tPosition pairCellPositions[PAIR_SIZE] = { (tPosition) { .row = row, .column = column } };
-    tIntSize candidates[PAIR_SIZE];
+bool technique_lockedCandidates_eliminate(tGrid *grid, tIntSize2 unit, tIntSize candidate, tIntSize2 target) {
     bool progress = false;
 
-    tIntSize const blockRow = grid_blockIndex(*grid, row);
-    tIntSize const blockCol = grid_blockIndex(*grid, column);
-
-    tCell *cellRowColumn = &grid_cellAt(*grid, row, column);
-
-    // Block
-    progress |= (cell_candidate_count(*cellRowColumn) >= 2
-                    && technique_hiddenPair_findPair(grid,
-                        blockRow, blockRow + grid->N,
-                        blockCol, blockCol + grid->N,
-                        pairCellPositions, candidates))
-             && technique_hiddenPair_removePairCells(grid, pairCellPositions, candidates);
-    // Row
-    progress |= (cell_candidate_count(*cellRowColumn) >= 2
-                    && technique_hiddenPair_findPair(grid,
-                        row, row + 1,
-                        0, grid_size(*grid),
-                        pairCellPositions, candidates))
-             && technique_hiddenPair_removePairCells(grid, pairCellPositions, candidates);
-    // Column
-    progress |= (cell_candidate_count(*cellRowColumn) >= 2
-                    && technique_hiddenPair_findPair(grid,
-                        0, grid_size(*grid),
-                        column, column + 1,
-                        pairCellPositions, candidates))
-             && technique_hiddenPair_removePairCells(grid, pairCellPositions, candidates);
+    // only visit the cells of the target unit that have the candidate
+    bitset_forEach(grid_unitPositions(*grid, target, candidate), grid_wordCount(*grid), position) {
+        tIntSize2 const iCell = grid_unitCellAt(*grid, target, position);
+        // do not remove the candidate from the intersection.
+        progress |= grid_unitOf(*grid, iCell, grid_unitKind(*grid, unit)) != unit && grid_cell_removeCandidate(grid, iCell, candidate);
+    }
 
     return progress;
 }
 
-bool technique_hiddenPair_findPair(
-    tGrid const *grid,
-    tIntSize rStart, tIntSize rEnd,
-    tIntSize cStart, tIntSize cEnd,
-    tPosition pairCellPositions[PAIR_SIZE], tIntSize candidates[PAIR_SIZE]) {
-    tCell firstPairCell = grid_cellAtPos(*grid, pairCellPositions[0]);
-
-    assert(cell_candidate_count(firstPairCell) >= 2);
+bool technique_nakedSubset(tGrid *grid, tIntSize2 unit, tIntSize maxSize) {
+    return technique_subset(grid, &(tSubsetMatrix) { .kind = SK_naked, .unit = unit }, maxSize);
+}
 
-    for (candidates[0] = 1; candidates[0] <= grid_size(*grid); candidates[0]++) {
-        if (!cell_hasCandidate(firstPairCell, candidates[0])) {
-            continue;
-        }
+bool technique_hiddenSubset(tGrid *grid, tIntSize2 unit, tIntSize maxSize) {
+    return technique_subset(grid, &(tSubsetMatrix) { .kind = SK_hidden, .unit = unit }, maxSize);
+}
 
-        for (candidates[1] = candidates[0] + 1; candidates[1] <= grid_size(*grid); candidates[1]++) {
-            if (!cell_hasCandidate(firstPairCell, candidates[1])) {
-                continue;
-            }
+bool technique_fish(tGrid *grid, tIntSize maxSize) {
+    bool progress = false;
 
-            // Start the search for a pair with new candidates.
-            if (technique_hiddenPair_findPairCells(
-                    grid, candidates,
-                    rStart, rEnd,
-                    cStart, cEnd,
-                    pairCellPositions)) {
-                return true;
-            }
-        }
+    for (tIntSize candidate = 1; candidate <= grid_size(*grid); candidate++) {
+        // Base rows, cover columns
+        progress |= technique_subset(grid, &(tSubsetMatrix) { .kind = SK_fish, .unit = grid_unit(*grid, UK_row, 0), .candidate = candidate }, maxSize);
+        // Base columns, cover rows
+        progress |= technique_subset(grid, &(tSubsetMatrix) { .kind = SK_fish, .unit = grid_unit(*grid, UK_column, 0), .candidate = candidate }, maxSize);
     }
 
-    return false;
+    return progress;
 }
 
-bool technique_hiddenPair_findPairCells(
-    tGrid const *grid, tIntSize const candidates[PAIR_SIZE],
-    tIntSize rStart, tIntSize rEnd,
-    tIntSize cStart, tIntSize cEnd,
-    tPosition pairCellPositions[PAIR_SIZE]) {
-    tIntSize nbPairCells = 1; // Count of cells found containing the pair (candidate1, candidate2).
-    tIntSize nbPairCellsContainingOtherCandidates = 0;
-
-    // Searching for hidden pairs
-    // Add each cell that contain both candidates
-    for (tIntSize r = rStart; r < rEnd && nbPairCells <= PAIR_SIZE + 1; r++) {
-        for (tIntSize c = cStart; c < cEnd && nbPairCells <= PAIR_SIZE + 1; c++) {
-            if (r == pairCellPositions[0].row && c == pairCellPositions[0].column) {
-                continue;
-            }
+bool technique_subset(tGrid *grid, tSubsetMatrix const *matrix, tIntSize maxSize) {
+    if (maxSize < 2) return false;
+
+    size_t const scratchMark = arena_mark(&grid->scratch);
+    tIntSize *rows = arena_array_alloc(&grid->scratch, rows, grid_size(*grid));
+    tIntSize *indexes = arena_array_alloc(&grid->scratch, indexes, maxSize);
+    tIntSize *subsetRows = arena_array_alloc(&grid->scratch, subsetRows, maxSize);
+    // The union of the first n rows of the subset is at index n. The union of no rows is empty.
+    tBitsetWord *unions = arena_array_alloc(&grid->scratch, unions, (size_t)(maxSize + 1) * grid_wordCount(*grid));
+    memset(unions, 0, sizeof *unions * grid_wordCount(*grid));
+
+    // When only pairs are searched, they are found while the rows are collected: the rows with 2 columns are bucketed by their first column.
+    // A pair is 2 rows of the same bucket with the same second column. SIZE is the end of a bucket.
+    // Otherwise, the combinations reach every pair on their way to the larger subsets, so indexing the pairs would only add work.
+    bool const isPairsOnly = maxSize == 2;
+    tIntSize *bucketHeads = NULL, *bucketNexts = NULL;
+    if (isPairsOnly) {
+        bucketHeads = arena_array_alloc(&grid->scratch, bucketHeads, grid_size(*grid));
+        bucketNexts = arena_array_alloc(&grid->scratch, bucketNexts, grid_size(*grid));
+        for (tIntSize column = 0; column < grid_size(*grid); column++) {
+            bucketHeads[column] = grid_size(*grid);
+        }
+    }
 
-            tCell cell = grid_cellAt(*grid, r, c);
+    bool progress = false;
 
-            if (cell_hasCandidate(cell, candidates[0])
-                && cell_hasCandidate(cell, candidates[1])) {
-                nbPairCellsContainingOtherCandidates += cell_candidate_count(cell) > PAIR_SIZE;
-                if (nbPairCells < PAIR_SIZE) {
-                    pairCellPositions[nbPairCells] = (tPosition) { .row = r, .column = c };
+    // A row with a single column is a singleton, and a row with more than maxSize columns cannot be in a subset.
+    tIntSize rowCount = 0;
+    for (tIntSize row = 0; row < grid_size(*grid); row++) {
+        tBitsetWord const *rowColumns = technique_subset_row(*grid, *matrix, row);
+        unsigned const columnCount = bitset_count(rowColumns, grid_wordCount(*grid));
+        if (2 <= columnCount && columnCount <= maxSize) {
+            rows[rowCount++] = row;
+
+            if (isPairsOnly && !progress) {
+                int const first = bitset_first(rowColumns);
+                int const second = bitset_next(rowColumns, grid_wordCount(*grid), first + 1);
+                for (tIntSize other = bucketHeads[first]; other != grid_size(*grid) && !progress; other = bucketNexts[other]) {
+                    if (bitset_has(technique_subset_row(*grid, *matrix, other), second)) {
+                        subsetRows[0] = other;
+                        subsetRows[1] = row;
+                        progress = technique_subset_eliminate(grid, matrix, subsetRows, 2, rowColumns);
+                    }
                 }
-                nbPairCells++;
-            }
-            // search for single candidates that would invalidate the pair
-            else if (cell_hasCandidate(cell, candidates[0])
-                     || cell_hasCandidate(cell, candidates[1])) {
-                return false;
+                bucketNexts[row] = bucketHeads[first];
+                bucketHeads[first] = row;
             }
         }
     }
 
-    // For the hidden pair to be useful, at least one cell of the pair must contain other candidates.
-    // Otherwise, we won't be able to remove any candidates.
-    return nbPairCells == PAIR_SIZE && nbPairCellsContainingOtherCandidates > 0;
-}
+    // Enumerate the combinations of rows depth first.
+    tIntSize size = 0, next = 0;
+    while (!progress && !isPairsOnly) {
+        if (next == rowCount || size == maxSize) {
+            // No more rows can be added: replace the last row of the subset with the ones after it.
+            if (size == 0) break;
+            next = indexes[--size] + 1;
+            continue;
+        }
 
-bool technique_hiddenPair_removePairCells(
-    tGrid *grid,
-    tPosition const pairCellPositions[PAIR_SIZE],
-    tIntSize const candidates[PAIR_SIZE]) {
-    bool progress = false;
-    // For each cell containing the pair:
-    for (tIntSize iPos = 0; iPos < PAIR_SIZE; ++iPos) {
-        tPosition pos = pairCellPositions[iPos];
-        // remove all its candidates
-        for (tIntSize candidate = 1; candidate <= grid_size(*grid); ++candidate) {
-            // except those forming the pair
-            progress |= candidate != candidates[0]
-                     && candidate != candidates[1]
-                     && grid_cell_removeCandidate(grid, pos.row, pos.column, candidate);
+        tBitsetWord const *rowColumns = technique_subset_row(*grid, *matrix, rows[next]);
+        tBitsetWord const *previousUnion = &unions[at2d(grid_wordCount(*grid), size, 0)];
+        tBitsetWord *currentUnion = &unions[at2d(grid_wordCount(*grid), size + 1, 0)];
+
+        unsigned columnCount = 0;
+        for (tIntSize w = 0; w < grid_wordCount(*grid); w++) {
+            currentUnion[w] = previousUnion[w] | rowColumns[w];
+            columnCount += word_popcount(currentUnion[w]);
+        }
+
+        // Adding rows never removes columns, so the combinations containing these rows are abandoned.
+        if (columnCount > maxSize) {
+            next++;
+            continue;
+        }
+
+        indexes[size] = next;
+        subsetRows[size] = rows[next];
+        size++;
+        next++;
+
+        if (size >= 2 && columnCount == size) {
+            progress = technique_subset_eliminate(grid, matrix, subsetRows, size, currentUnion);
         }
     }
+
+    arena_release(&grid->scratch, scratchMark);
     return progress;
 }
 
-bool technique_x_wing(tGrid *grid) {
+bool technique_subset_eliminate(tGrid *grid, tSubsetMatrix const *matrix,
+    tIntSize const *subsetRows, tIntSize size, tBitsetWord const *columns) {
     bool progress = false;
 
-    // VERTICAL X-WING
-    // identify 2 columns that each have, on the same rows, exactly two cells where a candidate appears.
-    /* We get a rectangle with these four cells as vertices:
-    _   _
-    A---B
-    |   |
-    C---D
-    ‾   ‾*/
-    for (tIntSize colAC = 0; colAC < grid_size(*grid); colAC++) {
-        for (tIntSize colBD = colAC + 1; colBD < grid_size(*grid); colBD++) {
-            for (tIntSize candidate = 1; candidate <= grid_size(*grid); candidate++) {
-                tIntSize rows[2];
-                tIntSize candidateInBothCount = 0;
-                tIntSize candidateCounts[2] = { 0 };
-                for (tIntSize row = 0; row < grid_size(*grid); row++) {
-                    bool colACHasCandidate = cell_hasCandidate(grid_cellAt(*grid, row, colAC), candidate);
-                    bool colBDHasCandidate = cell_hasCandidate(grid_cellAt(*grid, row, colBD), candidate);
-                    candidateCounts[0] += colACHasCandidate;
-                    candidateCounts[1] += colBDHasCandidate;
-                    if (colACHasCandidate && colBDHasCandidate) {
-                        if (candidateInBothCount < 2) {
-                            rows[candidateInBothCount] = row;
-                        }
-                        candidateInBothCount++;
-                    }
-                }
-                if (candidateInBothCount == 2 && candidateCounts[0] == 2 && candidateCounts[1] == 2) {
-                    // eliminate the candidate from the rows (AB) and (CD).
-                    for (tIntSize c = 0; c < grid_size(*grid); c++) {
-                        // do not remove the candidate from the cells that form the X.
-                        progress |= c != colAC && c != colBD && grid_cell_removeCandidate(grid, rows[0], c, candidate);
-                        progress |= c != colAC && c != colBD && grid_cell_removeCandidate(grid, rows[1], c, candidate);
-                    }
-                }
-            }
+    for (tIntSize row = 0; row < grid_size(*grid); row++) {
+        bool isSubsetRow = false;
+        for (tIntSize i = 0; i < size; i++) {
+            isSubsetRow |= subsetRows[i] == row;
         }
-    }
-
-    // HORIZONTAL X-WING
-    // identify 2 rows that each have, on the same columns, exactly two cells where a candidate appears.
-    /* We get a rectangle with these four cells as vertices:
-    (A---B)
-     |   |
-    (C---D)*/
-    for (tIntSize rowAB = 0; rowAB < grid_size(*grid); rowAB++) {
-        for (tIntSize rowCD = rowAB + 1; rowCD < grid_size(*grid); rowCD++) {
-            for (tIntSize candidate = 1; candidate <= grid_size(*grid); candidate++) {
-                tIntSize columns[2];
-                tIntSize candidateInBothCount = 0;
-                tIntSize candidateCounts[2] = { 0 };
-                for (tIntSize col = 0; col < grid_size(*grid); col++) {
-                    bool rowABHasCandidate = cell_hasCandidate(grid_cellAt(*grid, rowAB, col), candidate);
-                    bool rowCDHasCandidate = cell_hasCandidate(grid_cellAt(*grid, rowCD, col), candidate);
-                    candidateCounts[0] += rowABHasCandidate;
-                    candidateCounts[1] += rowCDHasCandidate;
-                    if (rowABHasCandidate && rowCDHasCandidate) {
-                        if (candidateInBothCount < 2) {
-                            columns[candidateInBothCount] = col;
-                        }
-                        candidateInBothCount++;
-                    }
-                }
-                if (candidateInBothCount == 2 && candidateCounts[0] == 2 && candidateCounts[1] == 2) {
-                    // elmininate the candidate from the columns (AC) and (BD).
-                    for (tIntSize r = 0; r < grid_size(*grid); r++) {
-                        // do not remove the candidate from the cells that form the X.
-                        progress |= r != rowAB && r != rowCD && grid_cell_removeCandidate(grid, r, columns[0], candidate);
-                        progress |= r != rowAB && r != rowCD && grid_cell_removeCandidate(grid, r, columns[1], candidate);
-                    }
-                }
+        if (isSubsetRow) continue;
+
+        bitset_forEach(columns, grid_wordCount(*grid), column) {
+            switch (matrix->kind) {
+            case SK_naked:
+                progress |= grid_cell_removeCandidate(grid, grid_unitCellAt(*grid, matrix->unit, row), column + 1);
+                break;
+            case SK_hidden:
+                progress |= grid_cell_removeCandidate(grid, grid_unitCellAt(*grid, matrix->unit, column), row + 1);
+                break;
+            case SK_fish:
+                progress |= grid_cell_removeCandidate(grid, grid_unitCellAt(*grid, matrix->unit + row, column), matrix->candidate);
+                break;
             }
         }
     }
@@ -7,127 +7,327 @@
 #define RESOLUTION_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
 
+#include "kernel.h"
 #include "types.h"
 
-/// @brief Performs the simple techniques on the grid.
+/// @brief Integer: node budget of a backtracking run that never pauses.
+#define BACKTRACKING_NO_LIMIT UINT64_MAX
+
+/// @brief Integer: solution limit of a resolution that finds all the solutions of the grid.
+#define SOLUTION_NO_LIMIT UINT64_MAX
+
+/// @brief Integer: largest size factor for which @ref BR_auto branches with snapshots.
+/// @remark Measured on hard grids: both strategies are even at N=3 (3 KB snapshots), and the trail is faster from N=4 (10 KB snapshots).
+#define BRANCH_SNAPSHOT_MAX_N 3
+
+/// @brief Gets the branch strategy of a resolution.
+/// @param grid in: the grid
+/// @param options in: the options of the resolution
+/// @return @ref BR_snapshot or @ref BR_trail: the branch strategy of @p options, chosen from the size factor of @p grid for @ref BR_auto.
+#define resolution_branchStrategy(grid, options) \
+    ((options)->branch != BR_auto ? (options)->branch : grid_N(grid) <= BRANCH_SNAPSHOT_MAX_N ? BR_snapshot : BR_trail)
+
+/// @brief Type of the entry point of a solver kernel.
+/// @param grid in/out: the grid to solve. Its scratch arena must be reserved.
+/// @param options in: the options of the resolution
+/// @param stats out: assigned to the statistics of the search
+/// @return Whether the grid has been solved. If not, the grid has no solution.
+typedef bool (*tResolutionSolveFunction)(tGrid *grid, tSolveOptions const *options, tSearchStats *stats);
+
+/// @brief Gets the solver kernel for a size factor.
+/// @param N in: grid size factor
+/// @return The kernel specialized for @p N, or the generic @ref resolution_solve if there is none.
+tResolutionSolveFunction resolution_getKernel(tIntN N);
+
+#define DECLARE_KERNEL(n) bool kernel_solveName(n)(tGrid * grid, tSolveOptions const *options, tSearchStats * stats);
+KERNEL_FOREACH_N(DECLARE_KERNEL)
+#undef DECLARE_KERNEL
+
+/// @brief Solves a grid: performs the logic techniques until they stall, then wraps up with a search.
+/// @param grid in/out: the grid to solve. Its scratch arena must have been reserved with at least @ref resolution_scratchSize bytes.
+/// @param options in: the options of the resolution
+/// @param stats out: assigned to the statistics of the search, including the number of solutions found
+/// @return Whether the grid has been solved. If not, the grid has no solution, unless @ref tSearchStats.gaveUp is set, and its values and candidates are unspecified.
+/// @remark The search goes on after each solution until @ref tSolveOptions.solutionLimit solutions are found. The grid then holds the last one. If the search ends before, the grid holds no specific solution.
+/// @remark Each solution is passed to @ref tSolveOptions.onSolution while the grid holds it, so solutions can be streamed without being stored.
+/// @remark This function does not allocate heap memory.
+/// @remark A contradiction found in the givens or by the techniques (see @ref tGrid.hasContradiction) rejects the grid before the search.
+/// @remark The @ref EN_local engine finds at most one solution, and may give up on a grid that has one. It then sets @ref tSearchStats.gaveUp.
+/// @remark If @ref tSolveOptions.dimacsOutput is set, the @ref EN_sat engine writes the encoding of the grid once the techniques stall, and the grid is not solved.
+KERNEL_LINKAGE bool resolution_solve(tGrid *grid, tSolveOptions const *options, tSearchStats *stats);
+
+/// @brief Computes the size of the scratch arena needed to solve a grid.
+/// @param grid in: the grid. Only its size factor is used, so the grid does not need to be loaded.
+/// @param options in: the options of the resolution
+/// @return The number of bytes to reserve in @ref tGrid.scratch before solving the grid.
+size_t resolution_scratchSize(tGrid const *grid, tSolveOptions const *options);
+
+/// @brief Computes the size of the scratch memory used by the subset and fish techniques.
+/// @param grid in: the grid
+/// @param maxSize in: the maximum size of the subsets
+/// @return The number of bytes carved from @ref tGrid.scratch while a matrix is searched for subsets.
+size_t resolution_subsetScratchSize(tGrid const *grid, tIntSize maxSize);
+
+/// @brief Computes the size of the scratch memory used by the search.
+/// @param grid in: the grid
+/// @param options in: the options of the resolution
+/// @return The number of bytes carved from @ref tGrid.scratch by the search.
+size_t resolution_searchScratchSize(tGrid const *grid, tSolveOptions const *options);
+
+/// @brief Computes the size of the scratch memory used by the scheduler of the techniques.
+/// @param grid in: the grid
+/// @return The number of bytes carved from @ref tGrid.scratch by the scheduler, while the techniques run.
+size_t resolution_schedulerScratchSize(tGrid const *grid);
+
+/// @brief Performs the techniques where the grid changed, until it is stable.
 /// @param grid in/out: the grid
+/// @param options in: the options of the resolution
+/// @param scheduler in/out: the scheduler of the techniques of the plan
 /// @return Whether progress has been made.
-bool perform_simpleTechniques(tGrid *grid);
+/// @remark The candidates of placed cells are removed from their peers first, then the naked singleton runs on the dirty cells and the hidden singleton on the dirty units. The techniques of the plan only run when these stall (see @ref resolution_escalate). The changes made by the techniques queue further work, so the queues of the grid and of the scheduler are empty when this function returns, unless it stops at a contradiction (see @ref tGrid.hasContradiction).
+KERNEL_LINKAGE bool resolution_propagate(tGrid *grid, tSolveOptions const *options, tScheduler *scheduler);
+
+/// @brief Runs the techniques of the plan on their pending units until one makes progress.
+/// @param grid in/out: the grid
+/// @param options in: the options of the resolution
+/// @param scheduler in/out: the scheduler
+/// @return Whether progress has been made. If not, no technique has pending units left.
+/// @remark The techniques are tried in the order of the plan, or from the best measured yield (@ref technique_yield) to the worst if the plan is adaptive. A technique that makes progress hands back to the singletons, so the costlier techniques only run when the cheaper ones stall.
+KERNEL_LINKAGE bool resolution_escalate(tGrid *grid, tSolveOptions const *options, tScheduler *scheduler);
 
-/// @brief Performs the backtracking technique.
+/// @brief Runs a technique on its pending units until it makes progress, and measures it.
 /// @param grid in/out: the grid
-/// @param emptyCellPositions in/out: the empty cell positions
-/// @param emptyCellCount in: the amount of empty cells (length of @p emptyCellPositions)
-/// @param iEmptyCellPositions in: index of the empty cell to start the backtracking from
+/// @param options in: the options of the resolution
+/// @param scheduler in/out: the scheduler
+/// @param technique in: the technique. Must have pending units.
 /// @return Whether progress has been made.
+/// @remark Used in @ref resolution_escalate.
+KERNEL_LINKAGE bool resolution_runTechnique(tGrid *grid, tSolveOptions const *options, tScheduler *scheduler, tTechnique technique);
+
+/// @brief Gets the yield of a technique.
+/// @param stats in: the statistics of the technique (@ref tTechniqueStats)
+/// @return The number of eliminations per nanosecond of the technique, as a double. Techniques that have not run yet get the prior @ref TECHNIQUE_YIELD_PRIOR_NS.
+#define technique_yield(stats) \
+    (((stats).eliminationCount + 1.0) / ((stats).nanoseconds + TECHNIQUE_YIELD_PRIOR_NS))
+
+/// @brief Reads a monotonic clock.
+/// @return The current time, in nanoseconds.
+static inline uint64_t resolution_nanoseconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+}
+
+/// @brief Records a solution found by the search of a resolution.
+/// @param grid in: the grid, which holds the solution
+/// @param options in: the options of the resolution
+/// @param solutionCount in/out: the number of solutions found so far. Incremented.
+/// @return Whether the search must go on: false once @ref tSolveOptions.solutionLimit solutions are found.
+/// @remark The solution is passed to @ref tSolveOptions.onSolution.
+KERNEL_LINKAGE bool resolution_recordSolution(tGrid const *grid, tSolveOptions const *options, uint64_t *solutionCount);
+
+/// @brief Starts a backtracking search.
+/// @param grid in/out: the grid. The stack of the search is carved from its scratch arena.
+/// @param search out: the search to start
+/// @param emptyCells in/out: the indexes of the empty cells. Reordered by the search.
+/// @param emptyCellCount in: the amount of empty cells (length of @p emptyCells)
+KERNEL_LINKAGE void technique_backtracking_start(tGrid *grid, tBacktracking *search, tIntSize2 *emptyCells, tIntSize2 emptyCellCount);
+
+/// @brief Runs a backtracking search until it ends or a number of nodes have been visited.
+/// @param grid in/out: the grid
+/// @param search in/out: the search, started with @ref technique_backtracking_start
+/// @param nodeBudget in: the maximum number of nodes to visit, or @ref BACKTRACKING_NO_LIMIT
+/// @return @ref BS_solved if a solution was found and written to the grid, @ref BS_exhausted if there is none, or @ref BS_paused if the budget ran out. A paused search is resumed by calling this function again.
 /// @remark This technique must be performed last, as it will always solve the grid completely.
-/// @remark After calling this function, it is possible that the candidates of the grid have an inconsistent state. This choice was made because it offers a performance gain and we no longer need the candidates once the grid is solved.
-bool technique_backtracking(tGrid *grid, tPosition *emptyCellPositions, tIntSize emptyCellCount, tIntSize iEmptyCellPosition);
+/// @remark This technique does not use candidates but the value presence bitsets of the units. After calling this function, it is possible that the candidates of the grid have an inconsistent state. This choice was made because it offers a performance gain and we no longer need the candidates once the grid is solved.
+KERNEL_LINKAGE tBacktrackingStatus technique_backtracking_run(tGrid *grid, tBacktracking *search, uint64_t nodeBudget);
+
+/// @brief Moves a backtracking search that found a solution on to the next one.
+/// @param search in/out: the search. Its last run must have returned @ref BS_solved.
+/// @return Whether other solutions may remain. If so, the next run searches for the next solution. Otherwise, the search is over.
+KERNEL_LINKAGE bool technique_backtracking_next(tBacktracking *search);
 
-/// @brief Swaps the cell at @p iHere with the cell after @p iHere having the least possible values in @p emptyCellPositions.
+/// @brief Swaps the cell at @p iHere with the cell after @p iHere having the least possible values in @p emptyCells.
 /// @param grid in: the grid
-/// @param emptyCellPositions in/out: the empty cell positions
-/// @param emptyCellCount in: the amount of empty cells (length of @p emptyCellPositions)
-/// @param iHere in: the index of the cell to swap
+/// @param emptyCells in/out: the indexes of the empty cells
+/// @param emptyCellCount in: the amount of empty cells (length of @p emptyCells)
+/// @param iHere in: the index in @p emptyCells of the cell to swap
+/// @remark The first cell having no possible value is selected without looking at the cells after it, which is the cell the whole scan would select.
 /// @remark Used in the backtracking technique.
-void technique_backtracking_swap_cells(tGrid const *grid, tPosition *emptyCellPositions, tIntSize emptyCellCount, tIntSize iHere);
+KERNEL_LINKAGE void technique_backtracking_swap_cells(tGrid const *grid, tIntSize2 *emptyCells, tIntSize2 emptyCellCount, tIntSize2 iHere);
+
+/// @brief Starts a forward checking search.
+/// @param grid in/out: the grid. Its candidates must be consistent with its values. The stack and the trail or the snapshots of the search are carved from its scratch arena.
+/// @param search out: the search to start
+/// @param emptyCells in: the indexes of the empty cells
+/// @param emptyCellCount in: the amount of empty cells (length of @p emptyCells)
+/// @param branch in: how the search goes back to the state of a depth. Must not be @ref BR_auto.
+KERNEL_LINKAGE void technique_forwardChecking_start(tGrid *grid, tForwardChecking *search, tIntSize2 *emptyCells, tIntSize2 emptyCellCount, tBranchStrategy branch);
+
+/// @brief Runs a forward checking search until it ends or a number of nodes have been visited.
+/// @param grid in/out: the grid
+/// @param search in/out: the search, started with @ref technique_forwardChecking_start
+/// @param nodeBudget in: the maximum number of nodes to visit, or @ref BACKTRACKING_NO_LIMIT
+/// @return @ref BS_solved if a solution was found and written to the grid, @ref BS_exhausted if there is none, or @ref BS_paused if the budget ran out. A paused search is resumed by calling this function again.
+/// @remark Unlike @ref technique_backtracking_run, this technique keeps the candidates of the grid consistent: each assumed value is removed from the candidates of the peers, and the resulting naked and hidden singles are assumed too, until a contradiction is found or the grid is stable.
+KERNEL_LINKAGE tBacktrackingStatus technique_forwardChecking_run(tGrid *grid, tForwardChecking *search, uint64_t nodeBudget);
+
+/// @brief Moves a forward checking search that found a solution on to the next one.
+/// @param search in/out: the search. Its last run must have returned @ref BS_solved.
+/// @return Whether other solutions may remain. If so, the next run searches for the next solution. Otherwise, the search is over.
+/// @remark The solution stays in the grid until the next run undoes the last assumption.
+KERNEL_LINKAGE bool technique_forwardChecking_next(tForwardChecking *search);
+
+/// @brief Selects the empty cell having the least candidates.
+/// @param grid in: the grid
+/// @param search in: the search
+/// @return The index of the selected cell, or @ref grid_cellCount if all the cells have a value.
+/// @remark Used in the forward checking technique.
+KERNEL_LINKAGE tIntSize2 technique_forwardChecking_selectCell(tGrid const *grid, tForwardChecking const *search);
+
+/// @brief Gives a value to a cell and queues it as placed, recording the change on the trail.
+/// @param grid in/out: the grid
+/// @param search in/out: the search
+/// @param iCell in: the index of the cell
+/// @param value in: the value
+/// @return Whether the value is consistent with the values of the units of the cell.
+/// @remark Used in the forward checking technique.
+KERNEL_LINKAGE bool technique_forwardChecking_assign(tGrid *grid, tForwardChecking *search, tIntSize2 iCell, tIntSize value);
+
+/// @brief Removes a candidate from a cell, recording the change on the trail, and assigns the singles it creates.
+/// @param grid in/out: the grid
+/// @param search in/out: the search
+/// @param iCell in: the index of the cell
+/// @param candidate in: the candidate to remove
+/// @return Whether the grid is still consistent: false if the cell or a unit of the cell has no place left for a value.
+/// @remark Used in the forward checking technique.
+KERNEL_LINKAGE bool technique_forwardChecking_removeCandidate(tGrid *grid, tForwardChecking *search, tIntSize2 iCell, tIntSize candidate);
+
+/// @brief Removes the values of the placed cells from the candidates of their peers, until the grid is stable.
+/// @param grid in/out: the grid
+/// @param search in/out: the search
+/// @return Whether the grid is still consistent. On a contradiction, the queue of placed cells is emptied.
+/// @remark Used in the forward checking technique.
+KERNEL_LINKAGE bool technique_forwardChecking_propagate(tGrid *grid, tForwardChecking *search);
+
+/// @brief Saves the state of the grid before the value of a depth is assumed.
+/// @param grid in: the grid
+/// @param search in/out: the search
+/// @param depth in: the depth
+/// @remark Used in the forward checking technique.
+KERNEL_LINKAGE void technique_forwardChecking_save(tGrid const *grid, tForwardChecking *search, tIntSize2 depth);
+
+/// @brief Goes back to the state of the grid saved for a depth.
+/// @param grid in/out: the grid
+/// @param search in/out: the search
+/// @param depth in: the depth. Its state must have been saved with @ref technique_forwardChecking_save.
+/// @remark Used in the forward checking technique.
+KERNEL_LINKAGE void technique_forwardChecking_restore(tGrid *grid, tForwardChecking *search, tIntSize2 depth);
+
+/// @brief Undoes the changes of the grid recorded on the trail of a search after a specific length.
+/// @param grid in/out: the grid
+/// @param search in/out: the search
+/// @param trailLength in: the length of the trail to go back to
+/// @remark Used in the forward checking technique.
+KERNEL_LINKAGE void technique_forwardChecking_undo(tGrid *grid, tForwardChecking *search, size_t trailLength);
 
 /// @brief Performs the naked singleton technique.
 /// @param grid in/out: the grid
-/// @param row in: the row of the targeted cell
-/// @param column in: the column of the targeted cell
+/// @param iCell in: the index of the targeted cell
 /// @return Whether progress has been made.
-bool technique_nakedSingleton(tGrid *grid, tIntSize row, tIntSize column);
+/// @remark The cell is queued as placed, its peers are not updated.
+/// @remark A cell left without candidates is a contradiction: it is recorded by @ref grid_cell_removeCandidate when its last candidate is removed.
+KERNEL_LINKAGE bool technique_nakedSingleton(tGrid *grid, tIntSize2 iCell);
 
 /// @brief Performs the hidden singleton technique.
 /// @param grid in/out: the grid
-/// @param row in: the row of the targeted cell
-/// @param column in: the column of the targeted cell
+/// @param unit in: the index of the targeted unit
 /// @return Whether progress has been made.
-bool technique_hiddenSingleton(tGrid *grid, tIntSize row, tIntSize column);
+/// @remark The cells that receive a value are queued as placed, their peers are not updated.
+/// @remark A value missing from the unit with no position left is a contradiction, recorded in @ref tGrid.hasContradiction.
+KERNEL_LINKAGE bool technique_hiddenSingleton(tGrid *grid, tIntSize2 unit);
 
-/// @brief Finds the unique candidate in a group.
+/// @brief Finds the unique candidate in a unit.
 /// @param grid in: the grid
-/// @param rStart in: search start row
-/// @param rEnd in: search end row (excluded)
-/// @param cStart in: search start column
-/// @param cEnd in: search end column (excluded)
-/// @param candidatePosition out: assigned to the position of the unique candidate found
-/// @return The unique candidate found, or 0 if none was found.
+/// @param unit in: the index of the unit to search
+/// @param iCandidateCell out: assigned to the index of the cell containing the unique candidate found
+/// @return The unique candidate found, 0 if none was found, or -1 if a value missing from the unit has no position.
 /// @remark Used in the hidden singleton technique.
-int technique_hiddenSingleton_findUniqueCandidate(
-    tGrid const *grid,
-    tIntSize rStart, tIntSize rEnd,
-    tIntSize cStart, tIntSize cEnd,
-    tPosition *candidatePosition);
+KERNEL_LINKAGE int technique_hiddenSingleton_findUniqueCandidate(tGrid const *grid, tIntSize2 unit, tIntSize2 *iCandidateCell);
 
-/// @brief Performs the naked pair technique.
+/// @brief Performs the locked candidates technique (pointing and claiming).
 /// @param grid in/out: the grid
-/// @param row in: the row of the targeted cell
-/// @param column in: the column of the targeted cell
+/// @param unit in: the index of the targeted unit
 /// @return Whether progress has been made.
-bool technique_nakedPair(tGrid *grid, tIntSize row, tIntSize column);
+/// @remark If the positions of a candidate in a block all lie in one row or column, the candidate is removed from the rest of that line (pointing). If the positions of a candidate in a line all lie in one block, the candidate is removed from the rest of that block (claiming).
+KERNEL_LINKAGE bool technique_lockedCandidates(tGrid *grid, tIntSize2 unit);
 
-/// @brief Checks if a cell is a naked pair cell (it only contains the candidates of @p pair).
-/// @param grid in: the grid
-/// @param cell in: the cell to check
-/// @return Whether the cell is a naked pair cell
-/// @remark Used in the naked pair technique.
-#define technique_nakedPair_isPairCell(cell, pair)     \
-    (cell_candidate_count(cell) == 2                   \
-        && cell_hasCandidate(cell, pair.candidates[0]) \
-        && cell_hasCandidate(cell, pair.candidates[1]))
-
-/// @brief Performs the hidden pair technique.
-/// @param grid in/out: the grid
-/// @param row in: the row of the targeted cell
-/// @param column in: the column of the targeted cell
+/// @brief Removes a candidate from the cells of a unit that are not in another unit.
+/// @param grid in/out: the grid
+/// @param unit in: the index of the unit containing all the positions of @p candidate
+/// @param candidate in: the candidate
+/// @param target in: the index of the unit to remove the candidate from
 /// @return Whether progress has been made.
-bool technique_hiddenPair(tGrid *grid, tIntSize row, tIntSize column);
+/// @remark Used in the locked candidates technique.
+KERNEL_LINKAGE bool technique_lockedCandidates_eliminate(tGrid *grid, tIntSize2 unit, tIntSize candidate, tIntSize2 target);
 
-/// @brief Finds a pair present exactly twice in a group.
-/// @param grid in: the grid
-/// @param rStart in: search start row
-/// @param rEnd in: search end row (excluded)
-/// @param cStart in: search start column
-/// @param cEnd in: search end column (excluded)
-/// @param pairCellPositions in/out: positions of the cells containing the found pair. The first element must contain the position of the first cell containing the pair.
-/// @param candidates out: filled with the pair's candididates
-/// @return Whether a pair has been found.
-/// @remark Used in the hidden singleton technique.
-bool technique_hiddenPair_findPair(
-    tGrid const *grid,
-    tIntSize rStart, tIntSize rEnd,
-    tIntSize cStart, tIntSize cEnd,
-    tPosition pairCellPositions[PAIR_SIZE], tIntSize candidates[PAIR_SIZE]);
+/// @brief Performs the naked subset technique.
+/// @param grid in/out: the grid
+/// @param unit in: the index of the targeted unit
+/// @param maxSize in: the maximum number of cells of a subset
+/// @return Whether progress has been made.
+/// @remark A naked subset is a set of cells of a unit that have, together, as many candidates as there are cells. These candidates must go in these cells, so they are removed from the other cells of the unit.
+KERNEL_LINKAGE bool technique_nakedSubset(tGrid *grid, tIntSize2 unit, tIntSize maxSize);
 
-/// @brief Removes the cells containing a pair of candidates.
+/// @brief Performs the hidden subset technique.
 /// @param grid in/out: the grid
-/// @param pairCellPositions in: positions of the pair cells
-/// @param candidates in: the pair's candidates
+/// @param unit in: the index of the targeted unit
+/// @param maxSize in: the maximum number of candidates of a subset
 /// @return Whether progress has been made.
-bool technique_hiddenPair_removePairCells(tGrid *grid,
-    tPosition const pairCellPositions[PAIR_SIZE], tIntSize const candidates[PAIR_SIZE]);
+/// @remark A hidden subset is a set of candidates of a unit that have, together, as many positions as there are candidates. These cells must hold these candidates, so their other candidates are removed.
+KERNEL_LINKAGE bool technique_hiddenSubset(tGrid *grid, tIntSize2 unit, tIntSize maxSize);
 
-/// @brief Finds the cells containing a pair of candidates.
+/// @brief Performs the fish technique (X-Wing, Swordfish, Jellyfish).
+/// @param grid in/out: the grid
+/// @param maxSize in: the maximum number of lines of a fish
+/// @return Whether progress has been made.
+/// @remark A fish of size n is a set of n base lines in which a candidate only appears on n crossing lines. The candidate must go in the cells where these lines cross, so it is removed from the rest of the crossing lines. A fish is a hidden subset of the matrix of the positions of a candidate in each line.
+KERNEL_LINKAGE bool technique_fish(tGrid *grid, tIntSize maxSize);
+
+/// @brief Gets a row of a candidate matrix.
 /// @param grid in: the grid
-/// @param candidates in: the pair's candidates
-/// @param rStart in: search start row
-/// @param rEnd in: search end row (excluded)
-/// @param cStart in: search start column
-/// @param cEnd in: search end column (excluded)
-/// @param pairCellPositions out: assigned to the positions of the cells containing the pair
-/// @return Whether a pair has been found.
-bool technique_hiddenPair_findPairCells(
-    tGrid const *grid, tIntSize const candidates[PAIR_SIZE],
-    tIntSize rStart, tIntSize rEnd,
-    tIntSize cStart, tIntSize cEnd,
-    tPosition pairCellPositions[PAIR_SIZE]);
-
-/// @brief Performs the X-Wing technique
+/// @param matrix in: the matrix (@ref tSubsetMatrix)
+/// @param row in: the index of the row, in range [0 ; SIZE[
+/// @return A pointer to a bitset of SIZE columns: the candidates of cell @p row (candidate @c c is column @c c-1), the positions of candidate @p row+1, or the positions of the candidate of the matrix in line @p row.
+/// @remark Used in the subset techniques.
+#define technique_subset_row(grid, matrix, row)                                                              \
+    ((matrix).kind == SK_naked    ? grid_candidates(grid, grid_unitCellAt(grid, (matrix).unit, (row)))        \
+        : (matrix).kind == SK_hidden ? grid_unitPositions(grid, (matrix).unit, (row) + 1)                     \
+                                     : grid_unitPositions(grid, (matrix).unit + (row), (matrix).candidate))
+
+/// @brief Finds a subset in a candidate matrix and performs its eliminations.
+/// @param grid in/out: the grid
+/// @param matrix in: the matrix
+/// @param maxSize in: the maximum number of rows of a subset
+/// @return Whether progress has been made. The search stops at the first subset that allows eliminations.
+/// @remark The rows are combined in increasing order and a combination is abandoned as soon as its union has more than @p maxSize columns, so only the rows having between 2 and @p maxSize columns are tried.
+/// @remark If @p maxSize is 2, the pairs (2 rows with the same 2 columns) are indexed instead: the rows are bucketed by their first column as they are collected, so a row is only compared with the rows of its bucket.
+/// @remark Used in the subset and fish techniques.
+KERNEL_LINKAGE bool technique_subset(tGrid *grid, tSubsetMatrix const *matrix, tIntSize maxSize);
+
+/// @brief Removes the columns of a subset from the other rows of a candidate matrix.
 /// @param grid in/out: the grid
+/// @param matrix in: the matrix
+/// @param subsetRows in: the rows of the subset
+/// @param size in: the number of rows of the subset (length of @p subsetRows)
+/// @param columns in: the bitset of the columns of the subset
 /// @return Whether progress has been made.
-bool technique_x_wing(tGrid *grid);
+/// @remark Used in the subset and fish techniques.
+KERNEL_LINKAGE bool technique_subset_eliminate(tGrid *grid, tSubsetMatrix const *matrix,
+    tIntSize const *subsetRows, tIntSize size, tBitsetWord const *columns);
 
 #endif // RESOLUTION_H
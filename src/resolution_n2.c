@@ -0,0 +1,7 @@
+/** @file
+ * @brief Solver kernel specialized for N=2
+ * @author 5cover, Matteo-K
+ */
+
+#define KERNEL_N 2
+#include "resolution.c"
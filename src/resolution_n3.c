@@ -0,0 +1,7 @@
+/** @file
+ * @brief Solver kernel specialized for N=3
+ * @author 5cover, Matteo-K
+ */
+
+#define KERNEL_N 3
+#include "resolution.c"
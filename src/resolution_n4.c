@@ -0,0 +1,7 @@
+/** @file
+ * @brief Solver kernel specialized for N=4
+ * @author 5cover, Matteo-K
+ */
+
+#define KERNEL_N 4
+#include "resolution.c"
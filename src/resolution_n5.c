@@ -0,0 +1,7 @@
+/** @file
+ * @brief Solver kernel specialized for N=5
+ * @author 5cover, Matteo-K
+ */
+
+#define KERNEL_N 5
+#include "resolution.c"
@@ -0,0 +1,754 @@
+/** @file
+ * @brief CDCL SAT engine implementation
+ * @author 5cover, Matteo-K
+ */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "bitset.h"
+#include "grid.h"
+#include "memdbg.h"
+#include "resolution.h"
+#include "sat.h"
+#include "utils.h"
+
+/// @brief Integer: number of at-least-one/at-most-one constraints of the grids of a size: one per cell, and one per value of each unit.
+#define sat_constraintCount(size) ((1 + UNIT_KIND_COUNT) * (size_t)(size) * (size))
+
+/// @brief Integer: flag of the learnt clauses, in the flags of the header of a clause. The other bits hold the LBD of the clause.
+#define SAT_LEARNT_FLAG ((uint32_t)1 << 31)
+
+/// @brief Real: factor the activity increment is divided by after each conflict.
+#define SAT_VARIABLE_DECAY 0.95
+
+/// @brief Real: activity above which all the activities are scaled down, so that they do not overflow.
+#define SAT_ACTIVITY_MAX 1e100
+
+/// @brief Integer: number of conflicts of the shortest restart interval. The intervals follow the Luby sequence.
+#define SAT_RESTART_UNIT 100
+
+/// @brief Integer: number of conflicts before the first reduction of the clause database.
+#define SAT_REDUCE_FIRST 2000
+
+/// @brief Integer: growth of the number of conflicts between two reductions of the clause database.
+#define SAT_REDUCE_INCREMENT 300
+
+/// @brief Integer: number of LBD buckets used to pick the learnt clauses to delete. Larger LBDs share the last bucket.
+#define SAT_LBD_BUCKET_COUNT 64
+
+/// @brief Gets the number of literals of a clause.
+#define sat_clauseSize(sat, clause) (sat)->_clauses[(clause)]
+
+/// @brief Gets the flags of a clause: @ref SAT_LEARNT_FLAG, and the LBD of a learnt clause.
+#define sat_clauseFlags(sat, clause) (sat)->_clauses[(clause) + 1]
+
+/// @brief Gets the clause after a clause in the watch list of one of its first two literals.
+#define sat_clauseLink(sat, clause, i) (sat)->_clauses[(clause) + 2 + (i)]
+
+/// @brief Gets the literals of a clause. The first two are the watched ones.
+#define sat_clauseLiterals(sat, clause) (&(sat)->_clauses[(clause) + SAT_CLAUSE_HEADER_LENGTH])
+
+/// @brief Gets the literal of a variable.
+/// @param variable in: the variable
+/// @param isFalse in: whether the literal is the negation of the variable
+#define sat_literal(variable, isFalse) (2 * (variable) + (isFalse))
+
+/// @brief Gets the variable of a literal.
+#define sat_variable(literal) ((literal) >> 1)
+
+/// @brief Gets the negation of a literal.
+#define sat_not(literal) ((literal) ^ 1)
+
+/// @brief Computes the number of clauses of an at-most-one constraint.
+/// @param length in: the number of literals of the constraint
+/// @return The number of binary clauses encoding the constraint.
+static inline size_t sat_atMostOneClauseCount(size_t length) {
+    if (length <= SAT_PAIRWISE_MAX_LENGTH) return length * (length - (length > 0)) / 2;
+    return 3 * length - 4;
+}
+
+/// @brief Computes the maximum number of variables of the encoding of the grids of a size.
+/// @param size in: the size of the grids
+/// @return The maximum number of variables: the candidates, and the auxiliary variables of the sequential counters.
+static inline size_t sat_variableBound(tIntSize size) {
+    return (size_t)size * size * size
+         + (size > SAT_PAIRWISE_MAX_LENGTH ? sat_constraintCount(size) * (size - 1u) : 0);
+}
+
+/// @brief Computes the number of words of the clauses of the encoding of the grids of a size, and of the clauses that can be added to it.
+/// @param grid in: the grid. Only its size factor is used.
+/// @param solutionLimit in: the solution limit of the search
+/// @return The number of words of the clause database.
+static inline size_t sat_clauseCapacity(tGrid const *grid, uint64_t solutionLimit) {
+    // Each constraint has at most SIZE literals: an at-least-one clause, and the binary clauses of at-most-one.
+    size_t const encodingWords = sat_constraintCount(grid_size(*grid))
+                               * (SAT_CLAUSE_HEADER_LENGTH + grid_size(*grid)
+                                   + sat_atMostOneClauseCount(grid_size(*grid)) * (SAT_CLAUSE_HEADER_LENGTH + 2));
+    // Each solution but the last is excluded by a clause of at most one literal per cell.
+    size_t const excludedSolutionCount = min(max(solutionLimit, 1u), SAT_MAX_SOLUTION_LIMIT + 0u) - 1;
+    return (1 + SAT_LEARNT_CAPACITY_FACTOR) * encodingWords
+         + excludedSolutionCount * (SAT_CLAUSE_HEADER_LENGTH + grid_cellCount(*grid));
+}
+
+/// @brief Checks whether a clause of a length fits in the clause database.
+#define sat_hasRoom(sat, length) ((sat)->_clauseLength + SAT_CLAUSE_HEADER_LENGTH + (length) <= (sat)->_clauseCapacity)
+
+/// @brief Adds a clause to the watch list of one of its first two literals.
+#define sat_watch(sat, clause, i)                                                                                   \
+    do {                                                                                                            \
+        uint32_t const _literal = sat_clauseLiterals(sat, clause)[i];                                               \
+        sat_clauseLink(sat, clause, i) = (sat)->_watches[_literal];                                                 \
+        (sat)->_watches[_literal] = (clause);                                                                       \
+    } while (0)
+
+/// @brief Exchanges two words.
+static inline void sat_swap(uint32_t *a, uint32_t *b) {
+    uint32_t const tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/// @brief Makes a literal true.
+/// @param sat in/out: the search
+/// @param literal in: the literal. Must be unassigned.
+/// @param reason in: the clause that implies the literal, or @ref SAT_NO_CLAUSE for a decision
+static inline void sat_enqueue(tSat *sat, uint32_t literal, uint32_t reason) {
+    assert(sat->_values[literal] == SAT_UNASSIGNED);
+    sat->_values[literal] = SAT_TRUE;
+    sat->_values[sat_not(literal)] = SAT_FALSE;
+    sat->_levels[sat_variable(literal)] = sat->_level;
+    sat->_reasons[sat_variable(literal)] = reason;
+    sat->_trail[sat->_trailLength++] = literal;
+}
+
+/// @brief Moves a variable of the heap towards its root, until its parent is at least as active.
+static inline void sat_heapUp(tSat *sat, uint32_t position) {
+    uint32_t const variable = sat->_heap[position];
+    while (position > 0) {
+        uint32_t const parent = (position - 1) / 2;
+        if (sat->_activities[sat->_heap[parent]] >= sat->_activities[variable]) break;
+        sat->_heap[position] = sat->_heap[parent];
+        sat->_heapPositions[sat->_heap[position]] = position;
+        position = parent;
+    }
+    sat->_heap[position] = variable;
+    sat->_heapPositions[variable] = position;
+}
+
+/// @brief Moves a variable of the heap towards its leaves, until its children are at most as active.
+static inline void sat_heapDown(tSat *sat, uint32_t position) {
+    uint32_t const variable = sat->_heap[position];
+    for (;;) {
+        uint32_t child = 2 * position + 1;
+        if (child >= sat->_heapLength) break;
+        if (child + 1 < sat->_heapLength && sat->_activities[sat->_heap[child + 1]] > sat->_activities[sat->_heap[child]]) child++;
+        if (sat->_activities[sat->_heap[child]] <= sat->_activities[variable]) break;
+        sat->_heap[position] = sat->_heap[child];
+        sat->_heapPositions[sat->_heap[position]] = position;
+        position = child;
+    }
+    sat->_heap[position] = variable;
+    sat->_heapPositions[variable] = position;
+}
+
+/// @brief Puts a variable back in the heap, unless it is in it already.
+static inline void sat_heapInsert(tSat *sat, uint32_t variable) {
+    if (sat->_heapPositions[variable] != SAT_NOT_IN_HEAP) return;
+    sat->_heap[sat->_heapLength] = variable;
+    sat_heapUp(sat, sat->_heapLength++);
+}
+
+/// @brief Removes the most active variable from the heap.
+/// @return The variable. The heap must not be empty.
+static inline uint32_t sat_heapRemoveMax(tSat *sat) {
+    uint32_t const variable = sat->_heap[0];
+    sat->_heapPositions[variable] = SAT_NOT_IN_HEAP;
+    if (--sat->_heapLength > 0) {
+        sat->_heap[0] = sat->_heap[sat->_heapLength];
+        sat_heapDown(sat, 0);
+    }
+    return variable;
+}
+
+/// @brief Increases the activity of a variable that took part in a conflict.
+static inline void sat_bump(tSat *sat, uint32_t variable) {
+    if ((sat->_activities[variable] += sat->_activityIncrement) > SAT_ACTIVITY_MAX) {
+        // Scaling all the activities keeps their order.
+        for (uint32_t v = 1; v <= sat->variableCount; v++) {
+            sat->_activities[v] /= SAT_ACTIVITY_MAX;
+        }
+        sat->_activityIncrement /= SAT_ACTIVITY_MAX;
+    }
+    if (sat->_heapPositions[variable] != SAT_NOT_IN_HEAP) sat_heapUp(sat, sat->_heapPositions[variable]);
+}
+
+/// @brief Gets the variable of a candidate of an empty cell.
+/// @param sat in: the search
+/// @param grid in: the grid
+/// @param iCell in: the index of the cell
+/// @param iValue in: the index of the candidate, which the cell must have
+/// @return The variable. The candidates of a cell have consecutive variables, in increasing order.
+static inline uint32_t sat_candidateVariable(tSat const *sat, tGrid const *grid, tIntSize2 iCell, tIntSize iValue) {
+    tBitsetWord const *candidates = grid_candidates(*grid, iCell);
+    uint32_t rank = 0;
+    for (tIntSize word = 0; word < iValue / BITSET_WORD_BITS; word++) {
+        rank += word_popcount(candidates[word]);
+    }
+    rank += word_popcount(candidates[iValue / BITSET_WORD_BITS] & (bitset_bitMask(iValue) - 1));
+    return sat->_cellVariables[iCell] + rank;
+}
+
+/// @brief Appends a clause to the clause database and watches its first two literals.
+/// @param sat in/out: the search
+/// @param literals in: the literals. There must be at least 2, and room for them.
+/// @param length in: the number of literals
+/// @param flags in: the flags of the clause
+/// @return The clause.
+static inline uint32_t sat_storeClause(tSat *sat, uint32_t const *literals, uint32_t length, uint32_t flags) {
+    assert(length >= 2 && sat_hasRoom(sat, length));
+    uint32_t const clause = (uint32_t)sat->_clauseLength;
+    sat_clauseSize(sat, clause) = length;
+    sat_clauseFlags(sat, clause) = flags;
+    memcpy(sat_clauseLiterals(sat, clause), literals, sizeof *literals * length);
+    sat_watch(sat, clause, 0);
+    sat_watch(sat, clause, 1);
+    sat->_clauseLength += SAT_CLAUSE_HEADER_LENGTH + length;
+    return clause;
+}
+
+/// @brief Adds a clause at decision level 0. Its literals that are false are dropped: a unit clause is a literal to propagate, and an empty one makes the clauses unsatisfiable.
+/// @param sat in/out: the search. Must be at decision level 0.
+/// @param literals in/out: the literals. Are reordered.
+/// @param length in: the number of literals
+static void sat_addRootClause(tSat *sat, uint32_t *literals, uint32_t length) {
+    assert(sat->_level == 0);
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < length; i++) {
+        switch (sat->_values[literals[i]]) {
+        case SAT_TRUE: return;
+        case SAT_UNASSIGNED: literals[kept++] = literals[i]; break;
+        }
+    }
+    switch (kept) {
+    case 0: sat->_unsatisfiable = true; break;
+    case 1: sat_enqueue(sat, literals[0], SAT_NO_CLAUSE); break;
+    default: sat_storeClause(sat, literals, kept, 0);
+    }
+}
+
+/// @brief Encodes that exactly one of the literals of @ref tSat._buffer is true.
+/// @param sat in/out: the search
+/// @param length in: the number of literals
+static void sat_encodeExactlyOne(tSat *sat, uint32_t length) {
+    uint32_t *literals = sat->_buffer;
+    uint32_t clause[2];
+
+    // At most one
+    if (length <= SAT_PAIRWISE_MAX_LENGTH) {
+        for (uint32_t i = 0; i < length; i++) {
+            for (uint32_t j = i + 1; j < length; j++) {
+                clause[0] = sat_not(literals[i]), clause[1] = sat_not(literals[j]);
+                sat_addRootClause(sat, clause, 2);
+            }
+        }
+    } else {
+        // Sequential counter: the auxiliary variable s_i is true if one of the first i+1 literals is.
+        uint32_t previous = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            if (i > 0) {
+                // Literal i cannot be true if one before it is.
+                clause[0] = sat_not(literals[i]), clause[1] = sat_literal(previous, true);
+                sat_addRootClause(sat, clause, 2);
+            }
+            if (i + 1 == length) break;
+
+            uint32_t const counter = ++sat->variableCount;
+            clause[0] = sat_not(literals[i]), clause[1] = sat_literal(counter, false);
+            sat_addRootClause(sat, clause, 2);
+            if (i > 0) {
+                clause[0] = sat_literal(previous, true), clause[1] = sat_literal(counter, false);
+                sat_addRootClause(sat, clause, 2);
+            }
+            previous = counter;
+        }
+    }
+
+    // At least one. Last, because it reorders the literals.
+    sat_addRootClause(sat, literals, length);
+}
+
+/// @brief Undoes the assignments of the decision levels above a level.
+/// @param sat in/out: the search
+/// @param level in: the level to go back to
+static void sat_backtrack(tSat *sat, uint32_t level) {
+    if (sat->_level <= level) return;
+    uint32_t const start = sat->_levelStarts[level + 1];
+    for (uint32_t i = sat->_trailLength; i-- > start;) {
+        uint32_t const literal = sat->_trail[i];
+        uint32_t const variable = sat_variable(literal);
+        sat->_values[literal] = sat->_values[sat_not(literal)] = SAT_UNASSIGNED;
+        sat->_phases[variable] = !(literal & 1);
+        if (variable <= sat->_candidateVariableCount) sat_heapInsert(sat, variable);
+    }
+    sat->_trailLength = sat->_propagated = start;
+    sat->_level = level;
+}
+
+/// @brief Propagates the literals of the trail through the clauses that watch their negation.
+/// @param sat in/out: the search
+/// @return A clause whose literals are all false, or @ref SAT_NO_CLAUSE if there is none.
+static uint32_t sat_propagate(tSat *sat) {
+    while (sat->_propagated < sat->_trailLength) {
+        uint32_t const falseLiteral = sat_not(sat->_trail[sat->_propagated++]);
+        uint32_t *link = &sat->_watches[falseLiteral];
+
+        while (*link != SAT_NO_CLAUSE) {
+            uint32_t const clause = *link;
+            uint32_t *literals = sat_clauseLiterals(sat, clause);
+
+            // Make the false literal the second watched one.
+            if (literals[0] == falseLiteral) {
+                literals[0] = literals[1];
+                literals[1] = falseLiteral;
+                sat_swap(&sat_clauseLink(sat, clause, 0), &sat_clauseLink(sat, clause, 1));
+            }
+            uint32_t *next = &sat_clauseLink(sat, clause, 1);
+
+            // The other watched literal satisfies the clause.
+            if (sat->_values[literals[0]] == SAT_TRUE) {
+                link = next;
+                continue;
+            }
+
+            // Watch another literal that is not false instead, if there is one.
+            uint32_t const size = sat_clauseSize(sat, clause);
+            uint32_t i = 2;
+            while (i < size && sat->_values[literals[i]] == SAT_FALSE) i++;
+            if (i < size) {
+                literals[1] = literals[i];
+                literals[i] = falseLiteral;
+                *link = *next;
+                sat_watch(sat, clause, 1);
+                continue;
+            }
+
+            // Otherwise, the clause implies its other watched literal, or conflicts if it is false.
+            if (sat->_values[literals[0]] == SAT_FALSE) return clause;
+            sat_enqueue(sat, literals[0], clause);
+            link = next;
+        }
+    }
+    return SAT_NO_CLAUSE;
+}
+
+/// @brief Analyses a conflict into a clause to learn, whose first literal is the negation of the first unique implication point of the conflict.
+/// @param sat in/out: the search. Must be above decision level 0.
+/// @param conflict in: the clause whose literals are all false
+/// @param backjumpLevel out: the decision level at which the learnt clause implies its first literal. Its second literal is of this level.
+/// @param lbd out: the number of distinct decision levels of the literals of the learnt clause
+/// @return The number of literals of the learnt clause, which is written to @ref tSat._buffer.
+static uint32_t sat_analyze(tSat *sat, uint32_t conflict, uint32_t *backjumpLevel, uint32_t *lbd) {
+    uint32_t *learnt = sat->_buffer;
+    uint32_t length = 1;
+
+    // Resolve the conflict with the reasons of its literals of the current level, latest first, until only one of them is left.
+    uint32_t pending = 0;
+    uint32_t literal = 0;
+    uint32_t index = sat->_trailLength;
+    uint32_t clause = conflict;
+    do {
+        uint32_t const *literals = sat_clauseLiterals(sat, clause);
+        // The first literal of a reason is the literal it implied.
+        for (uint32_t i = clause == conflict ? 0 : 1; i < sat_clauseSize(sat, clause); i++) {
+            uint32_t const variable = sat_variable(literals[i]);
+            if (sat->_seen[variable] || sat->_levels[variable] == 0) continue;
+            sat->_seen[variable] = true;
+            sat_bump(sat, variable);
+            if (sat->_levels[variable] == sat->_level) {
+                pending++;
+            } else {
+                learnt[length++] = literals[i];
+            }
+        }
+
+        do literal = sat->_trail[--index];
+        while (!sat->_seen[sat_variable(literal)]);
+        clause = sat->_reasons[sat_variable(literal)];
+        sat->_seen[sat_variable(literal)] = false;
+    } while (--pending > 0);
+    learnt[0] = sat_not(literal);
+
+    // Drop the literals implied by the others. The dropped literals are moved after the kept ones.
+    uint32_t kept = 1;
+    for (uint32_t i = 1; i < length; i++) {
+        uint32_t const reason = sat->_reasons[sat_variable(learnt[i])];
+        bool redundant = reason != SAT_NO_CLAUSE;
+        for (uint32_t j = 1; redundant && j < sat_clauseSize(sat, reason); j++) {
+            uint32_t const variable = sat_variable(sat_clauseLiterals(sat, reason)[j]);
+            redundant = sat->_seen[variable] || sat->_levels[variable] == 0;
+        }
+        if (!redundant) sat_swap(&learnt[kept++], &learnt[i]);
+    }
+    for (uint32_t i = 1; i < length; i++) {
+        sat->_seen[sat_variable(learnt[i])] = false;
+    }
+
+    // Watch a literal of the backjump level second, and count the levels.
+    *backjumpLevel = 0;
+    sat->_stamp++;
+    *lbd = 0;
+    for (uint32_t i = 0; i < kept; i++) {
+        uint32_t const level = sat->_levels[sat_variable(learnt[i])];
+        if (i > 0 && level > *backjumpLevel) {
+            *backjumpLevel = level;
+            sat_swap(&learnt[1], &learnt[i]);
+        }
+        if (sat->_levelStamps[level] != sat->_stamp) {
+            sat->_levelStamps[level] = sat->_stamp;
+            ++*lbd;
+        }
+    }
+
+    return kept;
+}
+
+/// @brief Deletes half of the learnt clauses, rounded up: those with the largest LBD, oldest first.
+/// @param sat in/out: the search. Must be at decision level 0, so that no clause is the reason of a literal of another level.
+static void sat_reduce(tSat *sat) {
+    assert(sat->_level == 0);
+
+    uint32_t counts[SAT_LBD_BUCKET_COUNT] = { 0 };
+    for (size_t clause = sat->_learntStart; clause < sat->_clauseLength; clause += SAT_CLAUSE_HEADER_LENGTH + sat_clauseSize(sat, clause)) {
+        if (sat_clauseFlags(sat, clause) & SAT_LEARNT_FLAG) {
+            counts[min(sat_clauseFlags(sat, clause) & ~SAT_LEARNT_FLAG, SAT_LBD_BUCKET_COUNT - 1u)]++;
+        }
+    }
+
+    // The clauses of the buckets from the threshold up are all deleted, and the oldest of the bucket below it until half are.
+    uint32_t deleteCount = (sat->_learntCount + 1) / 2;
+    uint32_t threshold = SAT_LBD_BUCKET_COUNT;
+    while (threshold > 0 && counts[threshold - 1] <= deleteCount) {
+        deleteCount -= counts[--threshold];
+    }
+
+    size_t length = sat->_learntStart;
+    for (size_t clause = sat->_learntStart; clause < sat->_clauseLength;) {
+        uint32_t const clauseLength = SAT_CLAUSE_HEADER_LENGTH + sat_clauseSize(sat, clause);
+        uint32_t const flags = sat_clauseFlags(sat, clause);
+        bool deleted = false;
+        if (flags & SAT_LEARNT_FLAG) {
+            uint32_t const bucket = min(flags & ~SAT_LEARNT_FLAG, SAT_LBD_BUCKET_COUNT - 1u);
+            if (bucket >= threshold) {
+                deleted = true;
+            } else if (bucket + 1 == threshold && deleteCount > 0) {
+                deleted = true;
+                deleteCount--;
+            }
+        }
+        if (deleted) {
+            sat->_learntCount--;
+        } else {
+            memmove(&sat->_clauses[length], &sat->_clauses[clause], sizeof *sat->_clauses * clauseLength);
+            length += clauseLength;
+        }
+        clause += clauseLength;
+    }
+    sat->_clauseLength = length;
+
+    // The clauses have moved: watch them again.
+    for (uint32_t literal = 0; literal < 2 * (sat->variableCount + 1); literal++) {
+        sat->_watches[literal] = SAT_NO_CLAUSE;
+    }
+    for (uint32_t clause = 0; clause < sat->_clauseLength; clause += SAT_CLAUSE_HEADER_LENGTH + sat_clauseSize(sat, clause)) {
+        sat_watch(sat, clause, 0);
+        sat_watch(sat, clause, 1);
+    }
+
+    // The literals of level 0 are never analysed, so their reasons are not needed anymore.
+    for (uint32_t i = 0; i < sat->_trailLength; i++) {
+        sat->_reasons[sat_variable(sat->_trail[i])] = SAT_NO_CLAUSE;
+    }
+}
+
+/// @brief Learns the clause written to @ref tSat._buffer by @ref sat_analyze, and backjumps to the level where it implies its first literal.
+/// @param sat in/out: the search
+/// @param length in: the number of literals of the clause
+/// @param backjumpLevel in: the level where the clause implies its first literal
+/// @param lbd in: the LBD of the clause
+static void sat_learn(tSat *sat, uint32_t length, uint32_t backjumpLevel, uint32_t lbd) {
+    uint32_t const *learnt = sat->_buffer;
+
+    if (length == 1) {
+        sat_backtrack(sat, 0);
+        sat_enqueue(sat, learnt[0], SAT_NO_CLAUSE);
+        return;
+    }
+
+    if (!sat_hasRoom(sat, length)) {
+        // The clause database is full: reduce it at level 0, where no clause is the reason of a literal that matters.
+        // None of the literals of the clause is of level 0, so it implies nothing there.
+        sat_backtrack(sat, 0);
+        do sat_reduce(sat);
+        while (!sat_hasRoom(sat, length));
+        sat_storeClause(sat, learnt, length, SAT_LEARNT_FLAG | lbd);
+        sat->_learntCount++;
+        return;
+    }
+
+    sat->_learntCount++;
+    sat_backtrack(sat, backjumpLevel);
+    sat_enqueue(sat, learnt[0], sat_storeClause(sat, learnt, length, SAT_LEARNT_FLAG | lbd));
+}
+
+/// @brief Gets an element of the Luby sequence: 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8...
+/// @param i in: the index of the element
+/// @return The element.
+static uint64_t sat_luby(uint32_t i) {
+    // Find the smallest complete subsequence that contains the element, then the subsequences that contain it inside of it.
+    uint64_t size = 1;
+    uint32_t exponent = 0;
+    while (size < (uint64_t)i + 1) {
+        exponent++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != i) {
+        size = (size - 1) / 2;
+        exponent--;
+        i %= size;
+    }
+    return (uint64_t)1 << exponent;
+}
+
+/// @brief Restarts the search from decision level 0, and reduces the clause database when it is due.
+/// @param sat in/out: the search
+static void sat_restart(tSat *sat) {
+    sat_backtrack(sat, 0);
+    sat->_restartLimit = sat->stats.backtrackCount + SAT_RESTART_UNIT * sat_luby(++sat->_restartCount);
+
+    if (sat->stats.backtrackCount >= sat->_reduceLimit) {
+        sat_reduce(sat);
+        sat->_reduceInterval += SAT_REDUCE_INCREMENT;
+        sat->_reduceLimit = sat->stats.backtrackCount + sat->_reduceInterval;
+    }
+}
+
+size_t sat_scratchSize(tGrid const *grid, uint64_t solutionLimit) {
+    size_t const variableCount = sat_variableBound(grid_size(*grid)) + 1;
+    size_t const candidateCount = (size_t)grid_cellCount(*grid) * grid_size(*grid) + 1;
+    // Cell variables + variable cells + variable values + clauses
+    return arena_size(sizeof(uint32_t) * grid_cellCount(*grid))
+         + arena_size(sizeof(tIntSize2) * candidateCount)
+         + arena_size(sizeof(tIntSize) * candidateCount)
+         + arena_size(sizeof(uint32_t) * sat_clauseCapacity(grid, solutionLimit))
+         // + watches + values
+         + arena_size(sizeof(uint32_t) * 2 * variableCount)
+         + arena_size(sizeof(int8_t) * 2 * variableCount)
+         // + levels + reasons + trail + buffer + level starts + level stamps
+         + 4 * arena_size(sizeof(uint32_t) * variableCount)
+         + 2 * arena_size(sizeof(uint32_t) * (variableCount + 1))
+         // + activities + heap + heap positions + phases + seen
+         + arena_size(sizeof(double) * variableCount)
+         + 2 * arena_size(sizeof(uint32_t) * variableCount)
+         + 2 * arena_size(sizeof(bool) * variableCount);
+}
+
+void sat_start(tSat *sat, tGrid *grid, uint64_t solutionLimit) {
+    size_t const variableCount = sat_variableBound(grid_size(*grid)) + 1;
+    size_t const candidateCount = (size_t)grid_cellCount(*grid) * grid_size(*grid) + 1;
+    sat->_clauseCapacity = sat_clauseCapacity(grid, solutionLimit);
+    assert(sat->_clauseCapacity < SAT_NO_CLAUSE);
+
+    sat->_cellVariables = arena_array_alloc(&grid->scratch, sat->_cellVariables, grid_cellCount(*grid));
+    sat->_variableCells = arena_array_alloc(&grid->scratch, sat->_variableCells, candidateCount);
+    sat->_variableValues = arena_array_alloc(&grid->scratch, sat->_variableValues, candidateCount);
+    sat->_clauses = arena_array_alloc(&grid->scratch, sat->_clauses, sat->_clauseCapacity);
+    sat->_watches = arena_array_alloc(&grid->scratch, sat->_watches, 2 * variableCount);
+    sat->_values = arena_array_alloc(&grid->scratch, sat->_values, 2 * variableCount);
+    sat->_levels = arena_array_alloc(&grid->scratch, sat->_levels, variableCount);
+    sat->_reasons = arena_array_alloc(&grid->scratch, sat->_reasons, variableCount);
+    sat->_trail = arena_array_alloc(&grid->scratch, sat->_trail, variableCount);
+    sat->_buffer = arena_array_alloc(&grid->scratch, sat->_buffer, variableCount);
+    sat->_levelStarts = arena_array_alloc(&grid->scratch, sat->_levelStarts, variableCount + 1);
+    sat->_activities = arena_array_alloc(&grid->scratch, sat->_activities, variableCount);
+    sat->_heap = arena_array_alloc(&grid->scratch, sat->_heap, variableCount);
+    sat->_heapPositions = arena_array_alloc(&grid->scratch, sat->_heapPositions, variableCount);
+    sat->_phases = arena_array_alloc(&grid->scratch, sat->_phases, variableCount);
+    sat->_seen = arena_array_alloc(&grid->scratch, sat->_seen, variableCount);
+    sat->_levelStamps = arena_array_alloc(&grid->scratch, sat->_levelStamps, variableCount + 1);
+
+    sat->variableCount = 0;
+    sat->_candidateVariableCount = 0;
+    sat->_clauseLength = 0;
+    sat->_learntCount = 0;
+    sat->_trailLength = 0;
+    sat->_propagated = 0;
+    sat->_level = 0;
+    sat->_activityIncrement = 1;
+    sat->_heapLength = 0;
+    sat->_stamp = 0;
+    sat->_unsatisfiable = grid->hasContradiction;
+    sat->_restartCount = 0;
+    sat->_restartLimit = SAT_RESTART_UNIT * sat_luby(0);
+    sat->_reduceInterval = SAT_REDUCE_FIRST;
+    sat->_reduceLimit = SAT_REDUCE_FIRST;
+    sat->stats = (tSearchStats) { 0 };
+
+    memset(sat->_values, SAT_UNASSIGNED, sizeof *sat->_values * 2 * variableCount);
+    memset(sat->_watches, 0xff, sizeof *sat->_watches * 2 * variableCount);
+    memset(sat->_seen, false, sizeof *sat->_seen * variableCount);
+    memset(sat->_levelStamps, 0, sizeof *sat->_levelStamps * (variableCount + 1));
+
+    // A grid that has a contradiction is left without clauses.
+    if (sat->_unsatisfiable) {
+        sat->_learntStart = 0;
+        return;
+    }
+
+    // The candidates of the empty cells are the variables. The cells that have a value need none.
+    for (tIntSize2 iCell = 0; iCell < grid_cellCount(*grid); iCell++) {
+        if (grid_value(*grid, iCell) != 0) {
+            sat->_cellVariables[iCell] = 0;
+            continue;
+        }
+        sat->_cellVariables[iCell] = sat->variableCount + 1;
+        bitset_forEach(grid_candidates(*grid, iCell), grid_wordCount(*grid), iValue) {
+            sat->variableCount++;
+            sat->_variableCells[sat->variableCount] = iCell;
+            sat->_variableValues[sat->variableCount] = (tIntSize)(iValue + 1);
+        }
+    }
+    sat->_candidateVariableCount = sat->variableCount;
+
+    // Each empty cell has exactly one of its candidates.
+    for (tIntSize2 iCell = 0; iCell < grid_cellCount(*grid); iCell++) {
+        if (grid_value(*grid, iCell) != 0) continue;
+        uint32_t length = 0;
+        for (tIntSize i = 0; i < grid_candidateCount(*grid, iCell); i++) {
+            sat->_buffer[length++] = sat_literal(sat->_cellVariables[iCell] + i, false);
+        }
+        sat_encodeExactlyOne(sat, length);
+    }
+
+    // Each unit has each of its missing values in exactly one of the cells that have it as a candidate.
+    for (tIntSize2 unit = 0; unit < grid_unitCount(*grid); unit++) {
+        for (tIntSize iValue = 0; iValue < grid_size(*grid); iValue++) {
+            if (bitset_has(grid_unitValues(*grid, unit), iValue)) continue;
+            uint32_t length = 0;
+            bitset_forEach(grid_unitPositions(*grid, unit, iValue + 1), grid_wordCount(*grid), position) {
+                tIntSize2 const iCell = grid_unitCellAt(*grid, unit, position);
+                sat->_buffer[length++] = sat_literal(sat_candidateVariable(sat, grid, iCell, iValue), false);
+            }
+            sat_encodeExactlyOne(sat, length);
+        }
+    }
+
+    sat->_learntStart = sat->_clauseLength;
+
+    // All the variables are unassigned, with the same activity. Only the candidates are decided on: once they all are, propagation has assigned the auxiliary variables.
+    for (uint32_t variable = 1; variable <= sat->variableCount; variable++) {
+        sat->_activities[variable] = 0;
+        sat->_phases[variable] = true;
+        sat->_heapPositions[variable] = SAT_NOT_IN_HEAP;
+    }
+    for (uint32_t variable = 1; variable <= sat->_candidateVariableCount; variable++) {
+        sat->_heap[sat->_heapLength++] = variable;
+        sat->_heapPositions[variable] = variable - 1;
+    }
+}
+
+tBacktrackingStatus sat_run(tSat *sat, tGrid *grid, uint64_t nodeBudget) {
+    if (sat->_unsatisfiable) return BS_exhausted;
+
+    for (;;) {
+        uint32_t const conflict = sat_propagate(sat);
+
+        if (conflict != SAT_NO_CLAUSE) {
+            sat->stats.backtrackCount++;
+            // A conflict that involves no decision: there is no solution.
+            if (sat->_level == 0) {
+                sat->_unsatisfiable = true;
+                return BS_exhausted;
+            }
+            uint32_t backjumpLevel, lbd;
+            uint32_t const length = sat_analyze(sat, conflict, &backjumpLevel, &lbd);
+            sat_learn(sat, length, backjumpLevel, lbd);
+            sat->_activityIncrement /= SAT_VARIABLE_DECAY;
+            continue;
+        }
+
+        if (sat->stats.backtrackCount >= sat->_restartLimit) sat_restart(sat);
+
+        if (nodeBudget == 0) return BS_paused;
+
+        // Decide on the most active unassigned variable.
+        uint32_t variable = 0;
+        while (sat->_heapLength > 0) {
+            uint32_t const candidate = sat_heapRemoveMax(sat);
+            if (sat->_values[sat_literal(candidate, false)] == SAT_UNASSIGNED) {
+                variable = candidate;
+                break;
+            }
+        }
+
+        // All the variables are assigned without conflict: the true candidate variables are a solution.
+        if (variable == 0) {
+            assert(sat->_trailLength == sat->variableCount);
+            for (uint32_t v = 1; v <= sat->_candidateVariableCount; v++) {
+                if (sat->_values[sat_literal(v, false)] == SAT_TRUE) {
+                    grid_value(*grid, sat->_variableCells[v]) = sat->_variableValues[v];
+                }
+            }
+            return BS_solved;
+        }
+
+        sat->_levelStarts[++sat->_level] = sat->_trailLength;
+        sat_enqueue(sat, sat_literal(variable, !sat->_phases[variable]), SAT_NO_CLAUSE);
+        sat->stats.nodeCount++;
+        nodeBudget -= nodeBudget != BACKTRACKING_NO_LIMIT;
+    }
+}
+
+bool sat_next(tSat *sat) {
+    // Exclude the solution: one of the candidates it chose must be false.
+    uint32_t length = 0;
+    for (uint32_t variable = 1; variable <= sat->_candidateVariableCount; variable++) {
+        if (sat->_values[sat_literal(variable, false)] == SAT_TRUE) {
+            sat->_buffer[length++] = sat_literal(variable, true);
+        }
+    }
+
+    sat_backtrack(sat, 0);
+    while (!sat_hasRoom(sat, length)) sat_reduce(sat);
+    sat_addRootClause(sat, sat->_buffer, length);
+
+    return !sat->_unsatisfiable;
+}
+
+void sat_writeDimacs(tSat const *sat, tGrid const *grid, FILE *outStream) {
+    fputs("c variable row column value\n", outStream);
+    for (uint32_t variable = 1; variable <= sat->_candidateVariableCount; variable++) {
+        tIntSize2 const iCell = sat->_variableCells[variable];
+        fprintf(outStream, "c %" PRIu32 " %d %d %d\n", variable,
+            iCell / grid_size(*grid) + 1, iCell % grid_size(*grid) + 1, sat->_variableValues[variable]);
+    }
+
+    size_t clauseCount = sat->_unsatisfiable + sat->_trailLength;
+    for (size_t clause = 0; clause < sat->_clauseLength; clause += SAT_CLAUSE_HEADER_LENGTH + sat_clauseSize(sat, clause)) {
+        clauseCount++;
+    }
+    fprintf(outStream, "p cnf %" PRIu32 " %zu\n", sat->variableCount, clauseCount);
+
+    if (sat->_unsatisfiable) fputs("0\n", outStream);
+    for (uint32_t i = 0; i < sat->_trailLength; i++) {
+        fprintf(outStream, "%s%" PRIu32 " 0\n", sat->_trail[i] & 1 ? "-" : "", sat_variable(sat->_trail[i]));
+    }
+    for (size_t clause = 0; clause < sat->_clauseLength; clause += SAT_CLAUSE_HEADER_LENGTH + sat_clauseSize(sat, clause)) {
+        for (uint32_t i = 0; i < sat_clauseSize(sat, clause); i++) {
+            uint32_t const literal = sat_clauseLiterals(sat, clause)[i];
+            fprintf(outStream, "%s%" PRIu32 " ", literal & 1 ? "-" : "", sat_variable(literal));
+        }
+        fputs("0\n", outStream);
+    }
+}
@@ -0,0 +1,80 @@
+/** @file
+ * @brief CDCL SAT engine header
+ * @author 5cover, Matteo-K
+ *
+ * The grid is encoded as a set of clauses, whose variables are the remaining candidates of its empty cells: each empty cell has exactly one of its candidates, and each unit has each of its missing values in exactly one of its cells.
+ * At-least-one is a single clause. At-most-one is a clause per pair of literals for short constraints, and a sequential counter for longer ones, which needs linearly many clauses and auxiliary variables instead of quadratically many.
+ * The clauses are solved by conflict-driven clause learning: each conflict is analysed down to its first unique implication point, which yields a clause that prevents it from happening again, and the search backjumps to the level where that clause implies a literal.
+ * Propagation watches two literals per clause. Decisions follow VSIDS activities with phase saving. The search restarts on the Luby sequence, and restarts periodically delete the half of the learnt clauses that involve the most decision levels.
+ */
+
+#ifndef SAT_H
+#define SAT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "types.h"
+
+/// @brief Integer: number of words of the header of a clause: its size, its flags, and the links of the watch lists of its first two literals.
+#define SAT_CLAUSE_HEADER_LENGTH 4
+
+/// @brief Integer: longest at-most-one constraint encoded with a clause per pair of literals. Longer ones use a sequential counter.
+#define SAT_PAIRWISE_MAX_LENGTH 6
+
+/// @brief Integer: room for learnt clauses, as a multiple of the room of the clauses of the encoding.
+#define SAT_LEARNT_CAPACITY_FACTOR 2
+
+/// @brief Integer: largest solution limit of a search. Each solution found adds a clause that excludes it, and the room for these clauses is reserved beforehand.
+#define SAT_MAX_SOLUTION_LIMIT 1024
+
+/// @brief Integer: clause that does not exist: the end of a watch list, or the reason of a decision.
+#define SAT_NO_CLAUSE UINT32_MAX
+
+/// @brief Integer: position in the heap of a variable that is not in it.
+#define SAT_NOT_IN_HEAP UINT32_MAX
+
+/// @brief Integer: value of a true literal.
+#define SAT_TRUE 1
+/// @brief Integer: value of a false literal.
+#define SAT_FALSE (-1)
+/// @brief Integer: value of an unassigned literal.
+#define SAT_UNASSIGNED 0
+
+/// @brief Computes the size of the scratch arena needed by a search.
+/// @param grid in: the grid. Only its size factor is used.
+/// @param solutionLimit in: the solution limit of the search (@ref tSolveOptions.solutionLimit). Room is reserved for the clauses that exclude the solutions found, up to @ref SAT_MAX_SOLUTION_LIMIT.
+/// @return The number of bytes to reserve in the scratch arena of the grid.
+size_t sat_scratchSize(tGrid const *grid, uint64_t solutionLimit);
+
+/// @brief Encodes a grid, and starts a search on its encoding.
+/// @param sat out: the search
+/// @param grid in/out: the grid. Its candidates must be consistent with its values. The clauses and the state of the search are carved from its scratch arena.
+/// @param solutionLimit in: the solution limit of the search, as given to @ref sat_scratchSize
+/// @remark A grid that has a contradiction is encoded as an empty clause.
+void sat_start(tSat *sat, tGrid *grid, uint64_t solutionLimit);
+
+/// @brief Runs a search until it ends or a number of decisions have been made.
+/// @param sat in/out: the search, started with @ref sat_start
+/// @param grid in/out: the grid
+/// @param nodeBudget in: the maximum number of decisions, or @ref BACKTRACKING_NO_LIMIT
+/// @return @ref BS_solved if a solution was found and written to the grid, @ref BS_exhausted if there is none, or @ref BS_paused if the budget ran out. A paused search is resumed by calling this function again.
+/// @remark The candidates of the grid are not updated.
+tBacktrackingStatus sat_run(tSat *sat, tGrid *grid, uint64_t nodeBudget);
+
+/// @brief Moves a search that found a solution on to the next one, by adding a clause that excludes the solution.
+/// @param sat in/out: the search. Its last run must have returned @ref BS_solved.
+/// @return Whether other solutions may remain. If so, the next run searches for the next solution. Otherwise, the search is over.
+/// @remark At most as many solutions as the solution limit given to @ref sat_start can be found, and no more than @ref SAT_MAX_SOLUTION_LIMIT.
+bool sat_next(tSat *sat);
+
+/// @brief Writes the encoding of a grid in DIMACS CNF format.
+/// @param sat in: the search, started with @ref sat_start and not run yet
+/// @param grid in: the grid
+/// @param outStream in: the stream to write to
+/// @remark Comment lines map each candidate variable to its cell and value. The literals the encoding already implies are written as unit clauses.
+void sat_writeDimacs(tSat const *sat, tGrid const *grid, FILE *outStream);
+
+#endif // SAT_H
@@ -9,14 +9,7 @@
 #include "tCell.h"
 
 int cell_candidateAt(tCell const *cell, tIntSize n) {
-    assert(n <= cell_candidate_count(*cell));
+    assert(1 <= n && n <= cell_candidate_count(*cell));
 
-    tIntSize candidate = 0;
-
-    while (n > 0) {
-        candidate++;
-        n -= cell->hasCandidate[candidate];
-    }
-
-    return candidate;
+    return bitset_nth(cell->candidates, n) + 1;
 }
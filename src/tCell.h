@@ -6,36 +6,36 @@
 #ifndef T_CELL_H
 #define T_CELL_H
 
+#include "bitset.h"
 #include "types.h"
 
 // Using macros to maximize the performance of these simple functions and procedures called very frequently in the program.
+// A cell is a view into the planes of its grid (see tCell). Prefer the plane macros of grid.h for scans over many cells.
 
 /// @brief Returns the number of candidates of a cell.
 /// @param cell in: the cell
 /// @return The number of candidates of @p cell.
-#define cell_candidate_count(cell) ((cell)._candidateCount)
+#define cell_candidate_count(cell) (*(cell)._candidateCount)
 
 /// @brief Determines whether a cell has a value.
 /// @param cell in: the cell
 /// @return A boolean indicating whether @p cell has a value.
-#define cell_hasValue(cell) ((cell)._value != 0)
+#define cell_hasValue(cell) (*(cell)._value != 0)
 
 /// @brief Determines whether a cell has a specific value as a candidate.
 /// @param cell in: the cell
 /// @param candidate in: the candidate to check
 /// @return A boolean indicating whether @p cell has @p candidate as a candidate.
-#define cell_hasCandidate(cell, candidate) ((cell).hasCandidate[candidate])
+#define cell_hasCandidate(cell, candidate) bitset_has((cell).candidates, (candidate) - 1)
 
 /// @brief Gets the first candidate of a cell in the range [1 ; @ref SIZE].
 /// @param cell in: the cell
 /// @param outVarName Name of the variable to declare and assign the result to.
 /// @return The first value in the range [1 ; @ref SIZE] that is a candidate of @p cell.
 /// @remark This macro is equivalent to calling @c cell_candidateAt(cell,1) but offers better performance as it does not require the overhead of a function call.
+/// @remark @p cell must have at least one candidate.
 #define cell_get_first_candidate(cell, outVarName) \
-    tIntSize outVarName = 1;                       \
-    while (!cell_hasCandidate(cell, outVarName)) { \
-        outVarName++;                              \
-    }
+    tIntSize outVarName = bitset_first((cell).candidates) + 1;
 
 /// @brief Returns the nth candidate of a cell in the range [1 ; @ref SIZE].
 /// @param cell in: the cell
@@ -7,8 +7,11 @@
 #define TYPES_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
+#include "arena.h"
 #include "const.h"
 
 #define array_malloc(name, length) malloc(sizeof *(name) * (length))
@@ -32,66 +35,612 @@ typedef uint_least8_t tIntN;
 /// @remark May be used for grid axis indexes, cell indexes, block indexes, value/candodate counts.
 typedef uint_least16_t tIntSize;
 
+/// @brief Type for a SIZE²-majored integer.
+/// @remark Range : [0; @ref MAX_SIZE²]
+/// @remark May be used for cell indexes and unit indexes.
+typedef uint_least32_t tIntSize2;
+
 /// @brief Maximum value of the grid size factor.
 #define MAX_N UINT_LEAST8_MAX
 /// @brief Maximum number of tiles in the grid. Equivalent to @ref MAX_N².
 #define MAX_SIZE UINT_LEAST16_MAX
 
-/// @brief A cell of a Sudoku grid
+/// @brief Type for a word of a bitset.
+/// @remark See bitset.h.
+typedef uint64_t tBitsetWord;
+
+/// @brief Kind of a unit: a group of SIZE cells that must contain every value exactly once.
+typedef enum {
+    UK_row,
+    UK_column,
+    UK_block,
+} tUnitKind;
+
+/// @brief Kind of a candidate matrix searched for subsets.
+/// @remark A subset is a set of rows of the matrix whose union has as many columns as there are rows.
+typedef enum {
+    /// @brief The rows are the cells of a unit and the columns are their candidates.
+    SK_naked,
+    /// @brief The rows are the candidates of a unit and the columns are their positions in the unit.
+    SK_hidden,
+    /// @brief The rows are the lines of a kind and the columns are the positions of a candidate in each line.
+    SK_fish,
+} tSubsetKind;
+
+/// @brief A candidate matrix searched for subsets.
+typedef struct {
+    /// @brief Kind of the matrix.
+    tSubsetKind kind;
+    /// @brief For a naked or hidden matrix, the index of the unit. For a fish matrix, the index of the first line, so that row @c r is unit @c unit+r.
+    tIntSize2 unit;
+    /// @brief For a fish matrix, the candidate. Unused otherwise.
+    tIntSize candidate;
+} tSubsetMatrix;
+
+/// @brief A FIFO queue of indexes in which each index is present at most once.
+/// @remark See queue.h.
+typedef struct {
+    /// @brief Circular buffer of the queued indexes.
+    /// @remark Dimensions: [capacity]
+    tIntSize2 *_items;
+
+    /// @brief Bitset representing for each index whether it is queued.
+    tBitsetWord *_queued;
+
+    /// @brief Number of distinct indexes, which is also the capacity of the buffer.
+    tIntSize2 capacity;
+
+    /// @brief Index of the first queued index in the buffer.
+    tIntSize2 _head;
+
+    /// @brief Number of queued indexes.
+    tIntSize2 _count;
+} tQueue;
+
+/// @brief A view of a cell of a Sudoku grid
+/// @remark The data of the cells is not stored in this structure but in the planes of @ref tGrid. A view points to the cell's element in each plane.
 typedef struct {
     /// @brief Value of the cell.
     /// @remark In range [1 ; SIZE]
-    tIntSize _value;
-
-    /// @brief Boolean dynamic array of length SIZE + 1 representing for each candidate whether it is present or not.
-    /// @remark The first ekement of the array at index 0 is unused. This is to allow direct indexation with the candidate value.
-    bool *hasCandidate;
+    /// @remark Points into @ref tGrid._values.
+    tIntSize *_value;
 
     /// @brief Number of candidates.
     /// @remark In range [0 ; SIZE]
-    tIntSize _candidateCount;
+    /// @remark Points into @ref tGrid._candidateCounts.
+    tIntSize *_candidateCount;
+
+    /// @brief Bitset of SIZE bits representing for each candidate whether it is present or not.
+    /// @remark Candidate @c c is stored at bit @c c-1.
+    /// @remark Points into @ref tGrid._candidates.
+    tBitsetWord *candidates;
 } tCell;
 
 /// @brief A Sudoku grid
+/// @remark The cells are stored as separate planes (one contiguous array per field), so that scans only touch the field they need.
 typedef struct {
-    /// @brief Square dynamic matrix of cells of side SIZE representing a Sudoku grid
-    /// @remark Dimensions: [rowIndex][columnIndex]
-    tCell *cells;
-
     /// @brief Grid size factor.
     /// @remark This member is semantically constant and should not be reassigned.
     tIntN N;
 
-    /// @brief Boolean dynamic matrix representing for each column whether the value is present or not.
-    /// @remark Dimensions: [columnIndex][value]
-    bool *_isColumnFree;
+    /// @brief Dynamic array holding the value of every cell, 0 for empty cells.
+    /// @remark Dimensions: [cellIndex]
+    tIntSize *_values;
+
+    /// @brief Dynamic array holding the number of candidates of every cell.
+    /// @remark Dimensions: [cellIndex]
+    tIntSize *_candidateCounts;
+
+    /// @brief Bitset dynamic array holding the candidates of every cell.
+    /// @remark Dimensions: [cellIndex][word]
+    tBitsetWord *_candidates;
 
-    /// @brief Boolean dynamic matrix representing for each row whether the value is present or not.
-    /// @remark Dimensions: [rowIndex][value]
-    bool *_isRowFree;
+    /// @brief Bitset dynamic array representing for each unit the values that are present in it.
+    /// @remark Dimensions: [unitIndex][word]
+    tBitsetWord *_unitValues;
 
-    /// @brief Boolean dynamic 3D array representing for each block whether the value is present or not.
-    /// @remark Dimensions: [blockRowIndex][blockColumnIndex][value]
-    bool *_isBlockFree;
+    /// @brief Bitset dynamic array representing for each unit and candidate the positions in the unit of the cells that have the candidate.
+    /// @remark Dimensions: [unitIndex][candidate - 1][word]
+    /// @remark Position @c p is stored at bit @c p.
+    tBitsetWord *_unitPositions;
+
+    /// @brief Dynamic matrix of the indexes of the units containing each cell.
+    /// @remark Dimensions: [cellIndex][unitKind]
+    tIntSize2 *_cellUnits;
+
+    /// @brief Dynamic matrix of the positions of each cell in the units containing it.
+    /// @remark Dimensions: [cellIndex][unitKind]
+    tIntSize *_cellPositions;
+
+    /// @brief Dynamic matrix of the indexes of the cells of each unit.
+    /// @remark Dimensions: [unitIndex][positionInUnit]
+    tIntSize2 *_unitCells;
+
+    /// @brief Dynamic matrix of the indexes of the peers of each cell (the cells that share a unit with it, excluding itself).
+    /// @remark Dimensions: [cellIndex][peerIndex]
+    tIntSize2 *_peers;
+
+    /// @brief Queue of the cells that received a value since their peers were last updated.
+    tQueue _placedCells;
+
+    /// @brief Queue of the cells whose candidates changed since the cell techniques last ran on them.
+    tQueue _dirtyCells;
+
+    /// @brief Queue of the units whose candidate positions changed since the unit techniques last ran on them.
+    tQueue _dirtyUnits;
+
+    /// @brief Number of candidates removed from the cells since the grid was loaded.
+    uint64_t eliminationCount;
+
+    /// @brief Whether the grid has been found to have no solution: a value is given twice in a unit, an empty cell has no candidates left, or a value missing from a unit has no position left in it.
+    /// @remark Set when loading the grid and by the techniques. The searches detect their own contradictions.
+    bool hasContradiction;
+
+    /// @brief Arena holding all the arrays of the grid.
+    tArena _arena;
+
+    /// @brief Scratch arena holding the temporary buffers of the resolution.
+    /// @remark Reserved once per solve. Temporary buffers are carved and released like a stack, using @ref arena_mark and @ref arena_release.
+    tArena scratch;
 } tGrid;
 
-/// @brief A position on the grid
+/// @brief A technique that runs once the singletons stall.
+/// @remark The naked and hidden singletons always run first, on every cell and unit that changed.
+typedef enum {
+    /// @brief Locked candidates (pointing and claiming), on each unit.
+    TE_lockedCandidates,
+    /// @brief Naked subsets, on each unit.
+    TE_nakedSubset,
+    /// @brief Hidden subsets, on each unit.
+    TE_hiddenSubset,
+    /// @brief Fish (X-Wing, Swordfish, Jellyfish), on the whole grid.
+    TE_fish,
+} tTechnique;
+
+/// @brief Statistics of a technique, measured while it runs.
+typedef struct {
+    /// @brief Number of units the technique ran on. The fish technique runs on the whole grid at once.
+    uint64_t runCount;
+    /// @brief Number of candidates it removed, including the ones removed by the singletons it placed.
+    uint64_t eliminationCount;
+    /// @brief Time spent running it, in nanoseconds.
+    uint64_t nanoseconds;
+} tTechniqueStats;
+
+/// @brief Schedules the techniques of the plan of a resolution.
+typedef struct {
+    /// @brief For each technique, queue of the units that changed since the technique last ran on them.
+    tQueue pending[TECHNIQUE_COUNT];
+    /// @brief Statistics of each technique.
+    tTechniqueStats stats[TECHNIQUE_COUNT];
+} tScheduler;
+
+/// @brief Statistics of a search.
 typedef struct {
-    /// @brief Row index.
-    /// @remark In range [0 ; SIZE[
-    tIntSize row;
-    /// @brief Column index.
-    /// @remark In range [0 ; SIZE[
-    tIntSize column;
-} tPosition;
-
-/// @brief Pair of 2 identical candidates with their positions.
+    /// @brief Number of nodes visited: values assumed for a cell.
+    uint64_t nodeCount;
+    /// @brief Number of backtracks: cells left after all their values were tried.
+    uint64_t backtrackCount;
+    /// @brief Number of solutions found. Filled by @ref resolution_solve only.
+    uint64_t solutionCount;
+    /// @brief Whether the search gave up before finding a solution or proving that there is none. Only the @ref EN_local engine gives up. Filled by @ref resolution_solve only.
+    bool gaveUp;
+    /// @brief Statistics of the techniques that ran before the search. Filled by @ref resolution_solve only.
+    tTechniqueStats techniques[TECHNIQUE_COUNT];
+} tSearchStats;
+
+/// @brief Outcome of a backtracking run.
+typedef enum {
+    /// @brief A solution was found and written to the grid.
+    BS_solved,
+    /// @brief All the values of all the cells were tried: there is no solution.
+    BS_exhausted,
+    /// @brief The node budget ran out. The search can be resumed.
+    BS_paused,
+} tBacktrackingStatus;
+
+/// @brief State of an iterative backtracking search.
+/// @remark The search is a depth-first search over the empty cells. Its stack holds one frame per depth: a cell, and the value assumed for it.
 typedef struct {
-    /// @brief Candidates.
-    tIntN candidates[PAIR_SIZE];
-    /// @brief Candidate count.
-    /// @remark In range [0 ; @ref PAIR_SIZE]
-    unsigned count;
-} tPair2;
+    /// @brief Indexes of the empty cells. The cell of depth @c d is at index @c d.
+    /// @remark The cells after the current depth are reordered as the search selects them.
+    tIntSize2 *emptyCells;
+
+    /// @brief Value assumed for the cell of each depth, 0 if none is yet.
+    /// @remark Dimensions: [depth]
+    tIntSize *_values;
+
+    /// @brief Number of empty cells, which is also the depth of a solution.
+    tIntSize2 emptyCellCount;
+
+    /// @brief Current depth of the search.
+    tIntSize2 _depth;
+
+    /// @brief Statistics of the search.
+    tSearchStats stats;
+} tBacktracking;
+
+/// @brief Search used to wrap up the resolution once the techniques stall.
+typedef enum {
+    /// @brief Backtracking on the value presence bitsets of the units. Its nodes are cheap, but nothing is propagated inside the search.
+    SA_backtracking,
+    /// @brief Backtracking that removes the assumed values from the candidates of the peers. Its nodes are more expensive, but singles and contradictions are found as soon as they appear.
+    SA_forwardChecking,
+} tSearchAlgorithm;
+
+/// @brief How a forward checking search goes back to the state of the grid of a depth.
+typedef enum {
+    /// @brief Chosen from the size of the grid.
+    BR_auto,
+    /// @brief Copies the state of the grid on each assumption, and copies it back to undo the assumption. Only for small grids, whose state fits in a few kilobytes.
+    BR_snapshot,
+    /// @brief Records each change of the grid on a trail, and undoes the changes in reverse order. Best for larger grids, where an assumption changes a small part of the state.
+    BR_trail,
+} tBranchStrategy;
+
+/// @brief Engine that solves the grid once the techniques stall.
+typedef enum {
+    /// @brief The search of @ref tSolveOptions.search.
+    EN_search,
+    /// @brief Dancing Links (Algorithm X) on the exact cover matrix of the grid. See dlx.h.
+    EN_dancingLinks,
+    /// @brief Conflict-driven clause learning on a CNF encoding of the grid. See sat.h.
+    EN_sat,
+    /// @brief Simulated annealing on complete assignments of the grid. See local.h.
+    EN_local,
+} tEngine;
+
+/// @brief A node of a Dancing Links matrix: a 1 of the matrix, or the header of a column.
+/// @remark The nodes of a column form a circular doubly-linked list through their header. The nodes of a row are not linked: they are contiguous, so the other nodes of a row are found by index.
+typedef struct {
+    /// @brief Index of the node above.
+    tIntSize2 up;
+    /// @brief Index of the node below.
+    tIntSize2 down;
+    /// @brief Index of the column of the node.
+    tIntSize2 column;
+    /// @brief Pads the node to 16 bytes, so that a node never straddles two cache lines.
+    tIntSize2 _padding;
+} tDlxNode;
+
+/// @brief The exact cover matrix of the grids of a size factor, and the state of the Dancing Links search running on it.
+/// @remark The rows of the matrix are the candidates of the cells: row @c iCell*SIZE+value-1 assigns a value to a cell. Its columns are the constraints: each cell has one value, and each row, column and block has each value once.
+/// @remark The matrix is built once, and reused by all the grids of its size factor: a search hides the rows and covers the columns the grid has eliminated, and uncovers them when it stops.
+/// @remark See dlx.h.
+typedef struct {
+    /// @brief Size factor of the grids of the matrix.
+    tIntN N;
+
+    /// @brief Nodes of the matrix. The @ref DLX_ROW_LENGTH nodes of each row come first, row by row, then the headers of the columns.
+    /// @remark Dimensions: [nodeIndex]
+    tDlxNode *_nodes;
+
+    /// @brief Number of nodes of each column that are in the matrix.
+    /// @remark Dimensions: [column]
+    tIntSize2 *_sizes;
+
+    /// @brief Column on the left of each column in the list of the uncovered columns. The last index is the root of the list.
+    /// @remark Dimensions: [column]
+    tIntSize2 *_left;
+
+    /// @brief Column on the right of each column in the list of the uncovered columns. The last index is the root of the list.
+    /// @remark Dimensions: [column]
+    tIntSize2 *_right;
+
+    /// @brief Node of the row chosen at each depth of the search, or @ref DLX_NO_NODE if none is yet.
+    /// @remark Dimensions: [depth]
+    tIntSize2 *_choices;
+
+    /// @brief Rows hidden or selected before the search started, in the order they were.
+    /// @remark Dimensions: [rowIndex]
+    tIntSize2 *_setupRows;
+
+    /// @brief Number of rows hidden before the search started. They come first in @ref tDlx._setupRows.
+    size_t _hiddenRowCount;
+
+    /// @brief Number of rows selected before the search started, for the cells that had a value. They come after the hidden ones in @ref tDlx._setupRows.
+    tIntSize2 _givenRowCount;
+
+    /// @brief Current depth of the search.
+    tIntSize2 _depth;
+
+    /// @brief Statistics of the search.
+    tSearchStats stats;
+
+    /// @brief Arena holding the matrix.
+    tArena _arena;
+} tDlx;
+
+/// @brief State of a CDCL search on the CNF encoding of a grid.
+/// @remark A variable is a candidate of an empty cell, or an auxiliary variable of an at-most-one constraint. Variable @c v has the literals @c 2v (true) and @c 2v+1 (false). Variable 0 is unused.
+/// @remark A clause is a run of @c uint32_t words in @ref tSat._clauses: its header (@ref SAT_CLAUSE_HEADER_LENGTH words), then its literals. It is referred to by the offset of its header.
+/// @remark See sat.h.
+typedef struct {
+    /// @brief Number of variables of the encoding.
+    uint32_t variableCount;
+
+    /// @brief Number of variables that are candidates. They come first, cell by cell, in the order of the candidates of the cell.
+    uint32_t _candidateVariableCount;
+
+    /// @brief First variable of the candidates of each cell, or 0 if the cell has a value.
+    /// @remark Dimensions: [iCell]
+    uint32_t *_cellVariables;
+
+    /// @brief Cell of each candidate variable.
+    /// @remark Dimensions: [variable]
+    tIntSize2 *_variableCells;
+
+    /// @brief Value of each candidate variable.
+    /// @remark Dimensions: [variable]
+    tIntSize *_variableValues;
+
+    /// @brief Clauses of the encoding, then the clauses learnt or added by the search.
+    /// @remark Dimensions: [word]
+    uint32_t *_clauses;
+
+    /// @brief Number of words of @ref tSat._clauses that can be used.
+    size_t _clauseCapacity;
+
+    /// @brief Number of words of @ref tSat._clauses that are used.
+    size_t _clauseLength;
+
+    /// @brief Offset of the first clause added after the encoding. Only the clauses after it are ever deleted.
+    size_t _learntStart;
+
+    /// @brief Number of learnt clauses, which the reductions of the clause database may delete.
+    uint32_t _learntCount;
+
+    /// @brief First clause of the watch list of each literal, or @ref SAT_NO_CLAUSE. The lists are linked through the headers of the clauses.
+    /// @remark Dimensions: [literal]
+    uint32_t *_watches;
+
+    /// @brief Value of each literal: @ref SAT_TRUE, @ref SAT_FALSE or @ref SAT_UNASSIGNED.
+    /// @remark Dimensions: [literal]
+    int8_t *_values;
+
+    /// @brief Decision level at which each variable was assigned.
+    /// @remark Dimensions: [variable]
+    uint32_t *_levels;
+
+    /// @brief Clause that implied the value of each variable, or @ref SAT_NO_CLAUSE for a decision.
+    /// @remark Dimensions: [variable]
+    uint32_t *_reasons;
+
+    /// @brief Literals made true, in the order they were.
+    /// @remark Dimensions: [variableCount]
+    uint32_t *_trail;
+
+    /// @brief Number of literals on the trail.
+    uint32_t _trailLength;
+
+    /// @brief Number of literals of the trail whose consequences have been propagated.
+    uint32_t _propagated;
+
+    /// @brief Length of the trail when each decision level began.
+    /// @remark Dimensions: [level]
+    uint32_t *_levelStarts;
+
+    /// @brief Current decision level. 0 holds the literals implied by the clauses alone.
+    uint32_t _level;
+
+    /// @brief VSIDS activity of each variable: how often it took part in recent conflicts.
+    /// @remark Dimensions: [variable]
+    double *_activities;
+
+    /// @brief Amount a conflict adds to the activity of its variables. It grows after each conflict, so that older conflicts weigh less.
+    double _activityIncrement;
+
+    /// @brief Binary max-heap of the candidate variables, by activity. The unassigned ones are always in it.
+    /// @remark Dimensions: [variableCount]
+    uint32_t *_heap;
+
+    /// @brief Number of variables in the heap.
+    uint32_t _heapLength;
+
+    /// @brief Position of each variable in the heap, or @ref SAT_NOT_IN_HEAP.
+    /// @remark Dimensions: [variable]
+    uint32_t *_heapPositions;
+
+    /// @brief Last value of each variable, which its next decision reuses (phase saving).
+    /// @remark Dimensions: [variable]
+    bool *_phases;
+
+    /// @brief Marks of the variables met by the analysis of a conflict.
+    /// @remark Dimensions: [variable]
+    bool *_seen;
+
+    /// @brief Literals of the clause being learnt or added.
+    /// @remark Dimensions: [variableCount]
+    uint32_t *_buffer;
+
+    /// @brief Last stamp of each decision level, to count the distinct levels of a clause.
+    /// @remark Dimensions: [level]
+    uint32_t *_levelStamps;
+
+    /// @brief Current stamp of @ref tSat._levelStamps.
+    uint32_t _stamp;
+
+    /// @brief Whether the clauses are known to have no solution.
+    bool _unsatisfiable;
+
+    /// @brief Number of restarts so far.
+    uint32_t _restartCount;
+
+    /// @brief Number of conflicts after which the search restarts.
+    uint64_t _restartLimit;
+
+    /// @brief Number of conflicts after which the next restart reduces the clause database.
+    uint64_t _reduceLimit;
+
+    /// @brief Number of conflicts between two reductions of the clause database. It grows after each reduction.
+    uint64_t _reduceInterval;
+
+    /// @brief Statistics of the search. The nodes are the decisions, and the backtracks the conflicts.
+    tSearchStats stats;
+} tSat;
+
+/// @brief State of a local search on complete assignments of a grid.
+/// @remark The values of the empty cells are held by the grid itself. Each block holds each value once: the search only swaps the values of two cells of a block, and each value stays a candidate of its cell.
+/// @remark See local.h.
+typedef struct {
+    /// @brief Cells that were empty when the search started, block by block.
+    /// @remark Dimensions: [freeCellIndex]
+    tIntSize2 *_freeCells;
+
+    /// @brief Index in @ref tLocalSearch._freeCells of the first free cell of each block. The last index is the number of free cells.
+    /// @remark Dimensions: [block + 1]
+    tIntSize2 *_blockStarts;
+
+    /// @brief Blocks that have at least two free cells, whose values can be swapped.
+    /// @remark Dimensions: [movableBlockIndex]
+    tIntSize *_movableBlocks;
+
+    /// @brief Number of blocks in @ref tLocalSearch._movableBlocks.
+    tIntSize _movableBlockCount;
+
+    /// @brief Number of cells of each row that have each value.
+    /// @remark Dimensions: [row][value - 1]
+    tIntSize *_rowCounts;
+
+    /// @brief Number of cells of each column that have each value.
+    /// @remark Dimensions: [column][value - 1]
+    tIntSize *_columnCounts;
+
+    /// @brief Free cell matched to each value by the filling of a block, or @ref LOCAL_NO_CELL.
+    /// @remark Dimensions: [value - 1]
+    tIntSize2 *_matches;
+
+    /// @brief Last stamp of each value, to visit each value once per augmenting path of the filling of a block.
+    /// @remark Dimensions: [value - 1]
+    uint32_t *_visits;
+
+    /// @brief Current stamp of @ref tLocalSearch._visits.
+    uint32_t _stamp;
+
+    /// @brief Number of duplicate values in the rows and the columns. The grid is solved when it is 0.
+    tIntSize2 _cost;
+
+    /// @brief Lowest cost since the last restart.
+    tIntSize2 _bestCost;
+
+    /// @brief Temperature of the annealing: the higher, the more moves that increase the cost are accepted.
+    double _temperature;
+
+    /// @brief Probability of accepting a move that increases the cost by each amount at the current temperature, scaled to 2^32.
+    /// @remark Dimensions: [delta]
+    uint64_t _acceptances[LOCAL_MAX_DELTA + 1];
+
+    /// @brief Number of moves tried at each temperature.
+    uint64_t _chainLength;
+
+    /// @brief Number of moves tried at the current temperature.
+    uint64_t _chainMoves;
+
+    /// @brief Number of temperatures since the lowest cost was last improved.
+    uint32_t _stallCount;
+
+    /// @brief State of the pseudo-random number generator.
+    uint64_t _random;
+
+    /// @brief Whether a block could not be filled: the grid has no solution.
+    bool _unsatisfiable;
+
+    /// @brief Statistics of the search. The nodes are the moves tried, and the backtracks the restarts.
+    tSearchStats stats;
+} tLocalSearch;
+
+/// @brief Receives the solutions found by a resolution.
+/// @param grid in: the grid, which holds the solution. Its candidates are unspecified.
+/// @param context in/out: the context of the handler (@ref tSolveOptions.solutionContext)
+typedef void (*tSolutionHandler)(tGrid const *grid, void *context);
+
+/// @brief Options of a resolution.
+typedef struct {
+    /// @brief Search used once the techniques stall.
+    tSearchAlgorithm search;
+    /// @brief How the forward checking search branches.
+    tBranchStrategy branch;
+    /// @brief Maximum size of the naked and hidden subsets. Subsets are not searched if it is less than 2.
+    tIntSize subsetMaxSize;
+    /// @brief Maximum size of the fish (2 for X-Wing, 3 for Swordfish, 4 for Jellyfish). Fish are not searched if it is less than 2.
+    tIntSize fishMaxSize;
+    /// @brief Techniques to run once the singletons stall, cheapest first.
+    tTechnique plan[TECHNIQUE_COUNT];
+    /// @brief Number of techniques in @ref tSolveOptions.plan.
+    tIntSize planLength;
+    /// @brief Whether the order of the plan adapts to the measured yield of the techniques, instead of being fixed.
+    bool adaptivePlan;
+    /// @brief Number of solutions after which the search stops: 1 to solve the grid, 2 to check that its solution is unique, or @ref SOLUTION_NO_LIMIT to count all its solutions. 0 is the same as 1.
+    uint64_t solutionLimit;
+    /// @brief Called on each solution found, as soon as it is found. NULL if the solutions are not needed one by one.
+    tSolutionHandler onSolution;
+    /// @brief Context passed to @ref tSolveOptions.onSolution.
+    void *solutionContext;
+    /// @brief Engine that solves the grid once the techniques stall.
+    tEngine engine;
+    /// @brief Matrix of the @ref EN_dancingLinks engine, built for the size factor of the grid. Unused by the other engines.
+    tDlx *dlx;
+    /// @brief Stream the @ref EN_sat engine writes its encoding to in DIMACS format, instead of solving it. NULL to solve it.
+    FILE *dimacsOutput;
+    /// @brief Seed of the pseudo-random moves of the @ref EN_local engine. The same seed gives the same search.
+    uint64_t seed;
+} tSolveOptions;
+
+/// @brief A change of the grid recorded by a forward checking search, so that it can be undone.
+typedef struct {
+    /// @brief Index of the changed cell.
+    tIntSize2 iCell;
+    /// @brief Candidate removed from the cell, or 0 if the cell received a value.
+    tIntSize candidate;
+} tTrailEntry;
+
+/// @brief State of an iterative forward checking search.
+/// @remark Like @ref tBacktracking, its stack holds one frame per depth: a cell, and the value assumed for it.
+/// @remark With @ref BR_trail, each change of the grid is recorded on the trail. A frame also holds the length of the trail before its value was assumed, so the search goes back to the state of the frame by undoing the changes recorded after it.
+/// @remark With @ref BR_snapshot, a frame holds a copy of the state of the grid before its value was assumed, so the search goes back to the state of the frame by copying it back.
+typedef struct {
+    /// @brief Indexes of the cells that were empty when the search started.
+    /// @remark Dimensions: [emptyCellCount]
+    tIntSize2 *emptyCells;
+
+    /// @brief Cell of each depth.
+    /// @remark Dimensions: [depth]
+    /// @remark The cell of the current depth is @ref grid_cellCount if all the cells have a value.
+    tIntSize2 *_cells;
+
+    /// @brief Value assumed for the cell of each depth, 0 if none is yet.
+    /// @remark Dimensions: [depth]
+    tIntSize *_values;
+
+    /// @brief How the search goes back to the state of a depth. Either @ref BR_snapshot or @ref BR_trail.
+    tBranchStrategy _branch;
+
+    /// @brief Length of the trail before the value of each depth was assumed.
+    /// @remark Dimensions: [depth]
+    /// @remark NULL with @ref BR_snapshot.
+    size_t *_trailLengths;
+
+    /// @brief Changes of the grid since the search started.
+    /// @remark Dimensions: [trailLength]
+    /// @remark NULL with @ref BR_snapshot.
+    tTrailEntry *_trail;
+
+    /// @brief Number of changes on the trail.
+    size_t _trailLength;
+
+    /// @brief State of the grid before the value of each depth was assumed.
+    /// @remark Dimensions: [depth][@ref grid_stateSize]
+    /// @remark NULL with @ref BR_trail.
+    unsigned char *_snapshots;
+
+    /// @brief Number of cells that were empty when the search started.
+    tIntSize2 emptyCellCount;
+
+    /// @brief Current depth of the search.
+    tIntSize2 _depth;
+
+    /// @brief Statistics of the search.
+    tSearchStats stats;
+} tForwardChecking;
 
 #endif // TYPES_H